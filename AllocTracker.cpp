@@ -0,0 +1,192 @@
+#include "AllocTracker.h"
+
+#ifdef ALLOC_TRACKING
+#include "GameConfig.h"
+#include <atomic>
+#include <fstream>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+
+namespace {
+    const int SUBSYSTEM_COUNT = (int)AllocSubsystem::COUNT;
+    const int PHASE_COUNT = (int)AllocPhase::COUNT;
+
+    const char* const SUBSYSTEM_NAMES[SUBSYSTEM_COUNT] = {
+        "game", "workers", "presenter", "telemetry", "recorder", "save"
+    };
+    const char* const PHASE_NAMES[PHASE_COUNT] = {
+        "outside-loop", "input", "tick-start", "players", "rules", "rooms", "enemies", "scripts", "lighting", "draw"
+    };
+
+    // Plain zero-initialized atomics, usable before any constructor has run
+    // (static objects allocate before main)
+    struct Counter {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> bytes;
+    };
+    Counter counters[SUBSYSTEM_COUNT][PHASE_COUNT];
+
+    std::atomic<uint8_t> phase;
+    std::atomic<bool> inTick;
+    std::atomic<bool> steady;
+    std::atomic<uint64_t> tickAllocations;  // Game thread and workers, current tick
+    std::atomic<bool> failing;              // Strict mode is already reporting one
+    std::atomic<int> ticksSinceWarmup;      // Restarted from room workers too
+
+    // Game thread only
+    uint64_t tickCount;
+    uint64_t steadyTicks;
+    uint64_t allocatingSteadyTicks;
+    uint64_t worstSteadyTick;
+
+    thread_local AllocSubsystem subsystem = AllocSubsystem::GAME;
+
+    bool isTickSubsystem(AllocSubsystem s) {
+        return s == AllocSubsystem::GAME || s == AllocSubsystem::WORKERS;
+    }
+
+    void track(size_t size) {
+        AllocPhase current = (AllocPhase)phase.load(std::memory_order_relaxed);
+        Counter& counter = counters[(int)subsystem][(int)current];
+        counter.count.fetch_add(1, std::memory_order_relaxed);
+        counter.bytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (!isTickSubsystem(subsystem) || !inTick.load(std::memory_order_relaxed)) return;
+        tickAllocations.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef ALLOC_STRICT
+        if (steady.load(std::memory_order_relaxed) && !failing.exchange(true)) {
+            // fprintf goes through the CRT heap, not operator new
+            fprintf(stderr, "\nAllocation of %u bytes in a steady tick (tick %llu, phase %s, %s)\n",
+                    (unsigned)size, (unsigned long long)tickCount, PHASE_NAMES[(int)current],
+                    SUBSYSTEM_NAMES[(int)subsystem]);
+            std::abort();
+        }
+#endif
+    }
+
+    void* allocate(size_t size) {
+        track(size);
+        void* block = std::malloc(size ? size : 1);
+        if (!block) throw std::bad_alloc();
+        return block;
+    }
+
+    // Blocks from here must go back through _aligned_free, the aligned deletes do that
+    void* allocateAligned(size_t size, std::align_val_t alignment) {
+        track(size);
+        void* block = _aligned_malloc(size ? size : 1, (size_t)alignment);
+        if (!block) throw std::bad_alloc();
+        return block;
+    }
+}
+
+void AllocTracker::setSubsystem(AllocSubsystem newSubsystem) {
+    subsystem = newSubsystem;
+}
+
+AllocPhase AllocTracker::setPhase(AllocPhase newPhase) {
+    return (AllocPhase)phase.exchange((uint8_t)newPhase, std::memory_order_relaxed);
+}
+
+void AllocTracker::beginTick() {
+    tickCount++;
+    steady = ticksSinceWarmup >= ALLOC_WARMUP_TICKS;
+    tickAllocations = 0;
+    inTick = true;
+}
+
+void AllocTracker::endTick() {
+    inTick = false;
+    if (steady) {
+        uint64_t allocations = tickAllocations;
+        steadyTicks++;
+        if (allocations > 0) allocatingSteadyTicks++;
+        if (allocations > worstSteadyTick) worstSteadyTick = allocations;
+    }
+    ticksSinceWarmup++;
+}
+
+// The next ticks may allocate while buffers grow to the new shape
+void AllocTracker::restartWarmup() {
+    ticksSinceWarmup = 0;
+    steady = false;
+}
+
+bool AllocTracker::writeReport(const std::string& filename) {
+    // Snapshot first, the report itself allocates
+    uint64_t count[SUBSYSTEM_COUNT][PHASE_COUNT];
+    uint64_t bytes[SUBSYSTEM_COUNT][PHASE_COUNT];
+    for (int s = 0; s < SUBSYSTEM_COUNT; s++) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            count[s][p] = counters[s][p].count;
+            bytes[s][p] = counters[s][p].bytes;
+        }
+    }
+
+    std::ofstream file(filename);
+    if (!file) return false;
+
+    file << "# Heap allocations since the program started, by thread and game loop phase\n";
+    file << "subsystem\tphase\tcount\tbytes\n";
+    for (int s = 0; s < SUBSYSTEM_COUNT; s++) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (count[s][p] == 0) continue;
+            file << SUBSYSTEM_NAMES[s] << "\t" << PHASE_NAMES[p] << "\t" << count[s][p] << "\t" << bytes[s][p] << "\n";
+        }
+    }
+
+    file << "\n# Ticks (game thread and pool workers only), steady after " << ALLOC_WARMUP_TICKS << " warmup ticks\n";
+    file << "ticks\t" << tickCount << "\n";
+    file << "steady\t" << steadyTicks << "\n";
+    file << "steady-allocating\t" << allocatingSteadyTicks << "\n";
+    file << "worst-steady-tick\t" << worstSteadyTick << "\n";
+    return true;
+}
+
+// Replacement global allocation functions, over-aligned ones included: the
+// alignas(64) rings in Telemetry, Recorder and FramePresenter come through those.
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete[](void* block) noexcept { std::free(block); }
+void operator delete(void* block, size_t) noexcept { std::free(block); }
+void operator delete[](void* block, size_t) noexcept { std::free(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { std::free(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { std::free(block); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete[](void* block, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete(void* block, size_t, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete[](void* block, size_t, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(block); }
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(block); }
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+// Thread an allocation came from. Threads tag themselves when they start,
+// anything untagged is the game thread.
+enum class AllocSubsystem : uint8_t {
+    GAME,
+    WORKERS,       // WorkerPool threads (room updates)
+    PRESENTER,
+    TELEMETRY,
+    RECORDER,
+    SAVE,
+    COUNT
+};
+
+// Part of the game loop the game thread is in. Pool workers count under the
+// phase that started them.
+enum class AllocPhase : uint8_t {
+    OUTSIDE_LOOP,  // Menus, loading, end of game
+    INPUT,         // Key handling, pause menu, save / load / rewind keys
+    TICK_START,    // Screen reload, rewind frame, tick script events
+    PLAYERS,       // Autopilots, moves, enter events
+    RULES,         // Switches, collisions, doors, springs, riddles
+    ROOMS,         // Room updates on the workers, detonations
+    ENEMIES,       // Enemy contact, spring effects
+    SCRIPTS,
+    LIGHTING,
+    DRAW,          // Frame composition and handing it to the presenter
+    COUNT
+};
+
+// Heap allocation counts for the AllocCheck and AllocStrict configurations
+// (ALLOC_TRACKING): the global operator new is replaced and counts every
+// allocation and its bytes by subsystem and phase. A tick is steady once
+// ALLOC_WARMUP_TICKS ticks have passed since the game started or last
+// changed shape (room change, reload, load, rewind). ALLOC_STRICT stops the
+// program at the first allocation the game thread or a pool worker makes
+// during a steady tick, naming the phase, so the debugger lands on the call
+// stack that allocated. Without ALLOC_TRACKING all of this compiles to nothing.
+namespace AllocTracker {
+#ifdef ALLOC_TRACKING
+    void setSubsystem(AllocSubsystem subsystem);  // For the calling thread
+    AllocPhase setPhase(AllocPhase phase);        // Returns the previous phase
+    void beginTick();
+    void endTick();
+    void restartWarmup();
+    bool writeReport(const std::string& filename);
+#else
+    inline void setSubsystem(AllocSubsystem) {}
+    inline AllocPhase setPhase(AllocPhase) { return AllocPhase::OUTSIDE_LOOP; }
+    inline void beginTick() {}
+    inline void endTick() {}
+    inline void restartWarmup() {}
+    inline bool writeReport(const std::string&) { return true; }
+#endif
+}
+
+// Sets the game loop phase for the scope, then puts the previous one back
+class AllocPhaseScope {
+private:
+    AllocPhase previous;
+
+public:
+    explicit AllocPhaseScope(AllocPhase phase) : previous(AllocTracker::setPhase(phase)) {}
+    ~AllocPhaseScope() { AllocTracker::setPhase(previous); }
+
+    // Prevent copying
+    AllocPhaseScope(const AllocPhaseScope&) = delete;
+    AllocPhaseScope& operator=(const AllocPhaseScope&) = delete;
+};
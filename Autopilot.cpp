@@ -0,0 +1,233 @@
+#include "Autopilot.h"
+#include "Room.h"
+#include "Player.h"
+#include "GameConfig.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+static const int UNKNOWN_COST = 1 << 30;
+
+Autopilot::Autopilot()
+    : room(nullptr), layoutVersion(-1),
+      goalCells(SCREEN_WIDTH, SCREEN_HEIGHT),
+      cost(SCREEN_WIDTH * SCREEN_HEIGHT, UNKNOWN_COST), nextCell(SCREEN_WIDTH * SCREEN_HEIGHT, -1),
+      closed(SCREEN_WIDTH, SCREEN_HEIGHT) {}
+
+int Autopilot::cellIndex(Point pos) const {
+    Point origin = window.getOrigin();
+    int x = pos.getX() - origin.getX();
+    int y = pos.getY() - origin.getY();
+    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+        return -1;
+    }
+    return y * SCREEN_WIDTH + x;
+}
+
+Point Autopilot::cellPoint(int cell) const {
+    Point origin = window.getOrigin();
+    return Point(origin.getX() + cell % SCREEN_WIDTH, origin.getY() + cell / SCREEN_WIDTH);
+}
+
+bool Autopilot::shouldDispose(const Player* player) const {
+    return player->hasItem() && !dynamic_cast<Key*>(player->getHeldItem());
+}
+
+PlayerAction Autopilot::think(const Room* currentRoom, const Player* player) {
+    // A launched player can't steer, just let the spring finish
+    if (player->hasReachedEnd() || player->isUnderSpringEffect()) {
+        return PlayerAction::STAY;
+    }
+
+    Point pos = player->getPosition();
+    if (currentRoom != room) {
+        window = Camera();
+        if (goalCells.getWidth() != currentRoom->getWidth() || goalCells.getHeight() != currentRoom->getHeight()) {
+            goalCells = BitGrid(currentRoom->getWidth(), currentRoom->getHeight());
+            closed = BitGrid(currentRoom->getWidth(), currentRoom->getHeight());
+        }
+    }
+    bool scrolled = window.follow(pos, currentRoom->getWidth(), currentRoom->getHeight());
+    int cell = cellIndex(pos);
+    if (cell < 0) return PlayerAction::STAY;
+
+    // Start over only if where we're going or what's in the way changed
+    chooseGoals(currentRoom, player);
+    if (currentRoom != room || currentRoom->getLayoutVersion() != layoutVersion ||
+        scrolled || nextGoals != goals) {
+        room = currentRoom;
+        layoutVersion = currentRoom->getLayoutVersion();
+        goals.swap(nextGoals);
+        restart();
+    }
+
+    if (!closed.test(pos)) {
+        search(pos);
+        if (!closed.test(pos)) {
+            return PlayerAction::STAY;  // Still planning, or no way to any goal
+        }
+    }
+
+    int next = nextCell[cell];
+    if (next < 0) return PlayerAction::STAY;  // Standing on the goal
+
+    Point nextPos = cellPoint(next);
+    int dx = nextPos.getX() - pos.getX();
+    int dy = nextPos.getY() - pos.getY();
+    if (dx > 0) return PlayerAction::RIGHT;
+    if (dx < 0) return PlayerAction::LEFT;
+    if (dy > 0) return PlayerAction::DOWN;
+    return PlayerAction::UP;
+}
+
+// Keys first, then a door the key opens, or the OFF switches keeping the doors shut
+void Autopilot::chooseGoals(const Room* currentRoom, const Player* player) {
+    nextGoals.clear();
+
+    if (dynamic_cast<Key*>(player->getHeldItem())) {
+        for (Door* door : currentRoom->getDoors()) {
+            if (cellIndex(door->getPosition()) >= 0 && currentRoom->areSwitchesActivated(door->getSwitchGroupId())) {
+                nextGoals.push_back(door->getPosition());
+            }
+        }
+        if (nextGoals.empty()) {
+            for (Switch* sw : currentRoom->getSwitches()) {
+                if (cellIndex(sw->getPosition()) >= 0 && !sw->getIsOn() &&
+                    !currentRoom->areSwitchesActivated(sw->getGroupId())) {
+                    nextGoals.push_back(sw->getPosition());
+                }
+            }
+        }
+        return;
+    }
+
+    for (Key* key : currentRoom->getKeys()) {
+        if (cellIndex(key->getPosition()) >= 0) {
+            nextGoals.push_back(key->getPosition());
+        }
+    }
+}
+
+// Seeds a new backward search from every goal
+void Autopilot::restart() {
+    std::fill(cost.begin(), cost.end(), UNKNOWN_COST);
+    std::fill(nextCell.begin(), nextCell.end(), -1);
+    closed.clear();
+    goalCells.clear();
+    open.clear();
+    target = Point(-1, -1);
+
+    for (const Point& goal : goals) {
+        int cell = cellIndex(goal);
+        if (cell < 0 || goalCells.testAndSet(goal)) continue;
+        cost[cell] = 0;
+        open.push_back({ 0, 0, cell });
+    }
+}
+
+// The heuristic aims at the player, so the open list is re-keyed when the player moved
+void Autopilot::retarget(Point playerPos) {
+    target = playerPos;
+    for (OpenNode& node : open) {
+        node.f = node.g + estimate(node.cell);
+    }
+    std::make_heap(open.begin(), open.end(), isBetter);
+}
+
+int Autopilot::estimate(int cell) const {
+    Point pos = cellPoint(cell);
+    return std::abs(pos.getX() - target.getX()) + std::abs(pos.getY() - target.getY());
+}
+
+// Expands cells until the player's cell is closed, the open list runs dry or the
+// tick's time budget is spent (checked every few expansions)
+void Autopilot::search(Point playerPos) {
+    if (open.empty()) return;
+    if (playerPos != target) {
+        retarget(playerPos);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::microseconds(BOT_PLAN_BUDGET_MICROS);
+    int expanded = 0;
+
+    while (!open.empty()) {
+        if ((++expanded & 15) == 0 && std::chrono::steady_clock::now() - start > budget) {
+            return;  // Out of time, continue next tick
+        }
+
+        std::pop_heap(open.begin(), open.end(), isBetter);
+        OpenNode node = open.back();
+        open.pop_back();
+
+        Point pos = cellPoint(node.cell);
+        if (node.g != cost[node.cell] || closed.testAndSet(pos)) {
+            continue;  // Stale entry
+        }
+
+        expand(node.cell);
+        if (pos == playerPos) {
+            return;
+        }
+    }
+}
+
+// Backward step: for each neighbor, could a player standing there walk into this cell?
+void Autopilot::expand(int cell) {
+    Point pos = cellPoint(cell);
+
+    for (int d = 1; d <= 4; d++) {
+        Direction dir = (Direction)d;
+        Point step = directionToPoint(dir);
+        Point from(pos.getX() - step.getX(), pos.getY() - step.getY());
+        int fromCell = cellIndex(from);
+        if (fromCell < 0 || closed.test(from) || !room->isPositionWalkable(from)) {
+            continue;
+        }
+
+        int enterCost = getEnterCost(pos, dir);
+        if (enterCost < 0) continue;
+
+        int g = cost[cell] + enterCost;
+        if (g < cost[fromCell]) {
+            cost[fromCell] = g;
+            nextCell[fromCell] = cell;
+            open.push_back({ g + estimate(fromCell), g, fromCell });
+            std::push_heap(open.begin(), open.end(), isBetter);
+        }
+    }
+}
+
+// Cost of stepping onto pos while moving in dir
+int Autopilot::getEnterCost(Point pos, Direction dir) const {
+    if (goalCells.test(pos)) return 1;
+
+    // Walking towards a spring's wall ends in a launch
+    SpringCell springCell = room->getSpringCellAt(pos);
+    if (springCell.spring) {
+        Point launch = directionToPoint(springCell.spring->getAlignment());
+        Point step = directionToPoint(dir);
+        bool towardsWall = step.getX() == -launch.getX() && step.getY() == -launch.getY();
+        return towardsWall ? BOT_DETOUR_COST : 1;
+    }
+
+    GameElement* elem = room->getElementAt(pos);
+    if (!elem) return 1;
+
+    // Pushing only works if the cell behind the obstacle is free
+    if (dynamic_cast<Obstacle*>(elem)) {
+        Point behind = pos + directionToPoint(dir);
+        return room->isPositionWalkable(behind) && !room->getElementAt(behind) ? BOT_PUSH_COST : -1;
+    }
+
+    // Other doors would leave the room, riddles need a human
+    if (!elem->canPlayerPass() || dynamic_cast<Door*>(elem) || dynamic_cast<Riddle*>(elem)) {
+        return -1;
+    }
+
+    // Items would fill our hands, switches would toggle, enemies bite
+    if (elem->isCollectible() || dynamic_cast<Switch*>(elem) || dynamic_cast<Enemy*>(elem)) {
+        return BOT_DETOUR_COST;
+    }
+    return 1;
+}
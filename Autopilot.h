@@ -0,0 +1,64 @@
+#pragma once
+#include "Point.h"
+#include "Direction.h"
+#include "KeyMap.h"
+#include "BitGrid.h"
+#include "Camera.h"
+#include <vector>
+
+class Room;
+class Player;
+
+// Drives a player without the keyboard: walks to a key, then to a door it can
+// open (or to the switches that lock it).
+// Routes come from an A* search that runs backwards from all goals towards the
+// player, so every cell the search has closed already knows its way to the
+// nearest goal and the tree stays useful when the player gets pushed off the
+// route (springs, other players).
+// The search runs for at most BOT_PLAN_BUDGET_MICROS per tick and resumes on
+// the next tick, the player waits meanwhile. The tree is only thrown away when
+// the goals or the room layout change (see Room::getLayoutVersion).
+// In rooms larger than the screen it only plans inside a screen-sized window
+// around the player, which restarts the search when it scrolls.
+class Autopilot {
+private:
+    struct OpenNode {
+        int f;     // g + distance to the player
+        int g;     // Cost from this cell to the nearest goal
+        int cell;
+    };
+
+    const Room* room;
+    int layoutVersion;
+    Camera window;  // Planned area, goals outside it are ignored
+    std::vector<Point> goals;
+    std::vector<Point> nextGoals;  // Scratch for chooseGoals
+    BitGrid goalCells;
+
+    std::vector<int> cost;      // cell -> cost to the nearest goal (g)
+    std::vector<int> nextCell;  // cell -> next cell on the way, -1 = goal or unknown
+    BitGrid closed;             // Cells whose cost and next cell are final
+    std::vector<OpenNode> open; // Binary heap, smallest f on top
+    Point target;               // Player position the heuristic aims at
+
+    int cellIndex(Point pos) const;  // -1 outside the window
+    Point cellPoint(int cell) const;
+    static bool isBetter(const OpenNode& a, const OpenNode& b) { return a.f > b.f; }
+
+    void chooseGoals(const Room* currentRoom, const Player* player);
+    void restart();
+    void search(Point playerPos);
+    void retarget(Point playerPos);
+    void expand(int cell);
+    int getEnterCost(Point pos, Direction dir) const;  // -1 = can't go there
+    int estimate(int cell) const;
+
+public:
+    Autopilot();
+
+    // Next movement command for the player: a direction, or STAY while planning / at the goal
+    PlayerAction think(const Room* currentRoom, const Player* player);
+
+    // True when the player holds something that is in the way of picking up a key
+    bool shouldDispose(const Player* player) const;
+};
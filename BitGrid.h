@@ -0,0 +1,136 @@
+#pragma once
+#include "Point.h"
+#include "GameConfig.h"
+#include "AllocTracker.h"
+#include <unordered_map>
+#include <array>
+#include <cstdint>
+
+// One bit per cell of a width x height grid, stored sparsely in
+// CHUNK_SIZE x CHUNK_SIZE chunks so that huge rooms only pay for the cells
+// that were actually set (field of view, explored area, blast ranges).
+// Grids of up to BITGRID_DENSE_CHUNKS chunks (every room that isn't chunked)
+// get all their chunks up front, so setting bits never allocates, unless made
+// with onDemand (rooms that are rarely blasted, see Room). Other grids free a
+// chunk that stayed empty for BITGRID_IDLE_CLEARS clears in a row, so a grid
+// refilled around a moving view keeps only the chunks near it.
+class BitGrid {
+private:
+    struct Chunk {
+        std::array<uint64_t, CHUNK_SIZE * CHUNK_SIZE / 64> bits;
+        int idleClears;  // Clears in a row that found it empty
+    };
+
+    int width;
+    int height;
+    int chunksPerRow;
+    bool dense;
+    std::unordered_map<int, Chunk> chunks;
+
+    bool isInside(Point pos) const {
+        return pos.getX() >= 0 && pos.getX() < width && pos.getY() >= 0 && pos.getY() < height;
+    }
+    int chunkKey(Point pos) const {
+        return (pos.getY() / CHUNK_SIZE) * chunksPerRow + pos.getX() / CHUNK_SIZE;
+    }
+    static int bitInChunk(Point pos) {
+        return (pos.getY() % CHUNK_SIZE) * CHUNK_SIZE + pos.getX() % CHUNK_SIZE;
+    }
+
+    Chunk& addChunk(int key) {
+        AllocTracker::restartWarmup();  // Ground never covered before, like a room chunk loading
+        Chunk& chunk = chunks[key];
+        chunk.bits.fill(0);
+        chunk.idleClears = 0;
+        return chunk;
+    }
+
+public:
+    BitGrid(int w, int h, bool onDemand = false)
+        : width(w), height(h), chunksPerRow((w + CHUNK_SIZE - 1) / CHUNK_SIZE) {
+        int chunkCount = chunksPerRow * ((h + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        dense = !onDemand && chunkCount <= BITGRID_DENSE_CHUNKS;
+        if (dense) {
+            for (int key = 0; key < chunkCount; key++) {
+                chunks[key].bits.fill(0);
+                chunks[key].idleClears = 0;
+            }
+        }
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Chunks in use stay allocated, a grid that is refilled every tick doesn't
+    // allocate. Freeing the idle ones doesn't allocate either.
+    void clear() {
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            Chunk& chunk = it->second;
+            bool used = false;
+            for (uint64_t word : chunk.bits) {
+                used = used || word != 0;
+            }
+            if (used) {
+                chunk.bits.fill(0);
+                chunk.idleClears = 0;
+            } else if (!dense && ++chunk.idleClears >= BITGRID_IDLE_CLEARS) {
+                it = chunks.erase(it);
+                continue;
+            }
+            ++it;
+        }
+    }
+
+    // Frees the chunk holding pos (Room, when the room chunk there is unloaded)
+    void releaseChunk(Point pos) {
+        if (!dense && isInside(pos)) {
+            chunks.erase(chunkKey(pos));
+        }
+    }
+
+    void orWith(const BitGrid& other) {
+        for (const auto& entry : other.chunks) {
+            auto it = chunks.find(entry.first);
+            if (it == chunks.end()) {
+                addChunk(entry.first).bits = entry.second.bits;
+                continue;
+            }
+            for (int i = 0; i < (int)entry.second.bits.size(); i++) {
+                it->second.bits[i] |= entry.second.bits[i];
+            }
+        }
+    }
+
+    // Cells outside the grid read as unset
+    bool test(Point pos) const {
+        if (!isInside(pos)) return false;
+        auto it = chunks.find(chunkKey(pos));
+        if (it == chunks.end()) return false;
+        int i = bitInChunk(pos);
+        return (it->second.bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(Point pos) {
+        if (!isInside(pos)) return;
+        auto it = chunks.find(chunkKey(pos));
+        Chunk& chunk = it == chunks.end() ? addChunk(chunkKey(pos)) : it->second;
+        int i = bitInChunk(pos);
+        chunk.bits[i >> 6] |= (uint64_t)1 << (i & 63);
+    }
+
+    void reset(Point pos) {
+        if (!isInside(pos)) return;
+        auto it = chunks.find(chunkKey(pos));
+        if (it == chunks.end()) return;
+        int i = bitInChunk(pos);
+        it->second.bits[i >> 6] &= ~((uint64_t)1 << (i & 63));
+    }
+
+    // Sets the bit and returns its previous value (true for cells outside the grid)
+    bool testAndSet(Point pos) {
+        if (!isInside(pos)) return true;
+        bool was = test(pos);
+        set(pos);
+        return was;
+    }
+};
@@ -5,9 +5,10 @@ class Bomb : public GameElement {
 private:
     int ticksRemaining;
     bool activated;
+    bool detonated;
     
 public:
-    Bomb(Point pos) : GameElement(pos, '@'), ticksRemaining(-1), activated(false) {}
+    Bomb(Point pos) : GameElement(pos, '@'), ticksRemaining(-1), activated(false), detonated(false) {}
     
     bool canPlayerPass() const override { return true; }
     bool isCollectible() const override { return !activated; }
@@ -18,6 +19,18 @@ public:
     }
     
     bool isActivated() const { return activated; }
+    int getTicksRemaining() const { return ticksRemaining; }
+    
+    // Quick-load: put the fuse back where it was
+    void restoreState(bool wasActivated, int ticks, bool wasDetonated) {
+        activated = wasActivated;
+        ticksRemaining = ticks;
+        detonated = wasDetonated;
+    }
+    
+    // Set once the bomb goes off (by its own fuse or caught in another blast)
+    void detonate() { detonated = true; }
+    bool hasDetonated() const { return detonated; }
     
     // Returns true if bomb exploded
     bool tick() {
@@ -0,0 +1,48 @@
+#pragma once
+#include "Point.h"
+#include "GameConfig.h"
+
+// Screen-sized window into a room, top-left corner in room coordinates.
+// It only scrolls when the followed point gets within a quarter screen of an
+// edge, and never shows anything outside the room. Rooms that fit on the
+// screen always see origin (0, 0).
+class Camera {
+private:
+    Point origin;
+
+    static int clampAxis(int value, int roomSize, int screenSize) {
+        if (value > roomSize - screenSize) value = roomSize - screenSize;
+        if (value < 0) value = 0;
+        return value;
+    }
+
+public:
+    Camera() : origin(0, 0) {}
+
+    Point getOrigin() const { return origin; }
+
+    bool contains(Point pos) const {
+        return pos.getX() >= origin.getX() && pos.getX() < origin.getX() + SCREEN_WIDTH &&
+               pos.getY() >= origin.getY() && pos.getY() < origin.getY() + SCREEN_HEIGHT;
+    }
+
+    // Returns true if the window moved
+    bool follow(Point target, int roomWidth, int roomHeight) {
+        int x = origin.getX();
+        int y = origin.getY();
+        int marginX = SCREEN_WIDTH / 4;
+        int marginY = SCREEN_HEIGHT / 4;
+
+        if (target.getX() < x + marginX || target.getX() >= x + SCREEN_WIDTH - marginX) {
+            x = target.getX() - SCREEN_WIDTH / 2;
+        }
+        if (target.getY() < y + marginY || target.getY() >= y + SCREEN_HEIGHT - marginY) {
+            y = target.getY() - SCREEN_HEIGHT / 2;
+        }
+
+        Point moved(clampAxis(x, roomWidth, SCREEN_WIDTH), clampAxis(y, roomHeight, SCREEN_HEIGHT));
+        if (moved == origin) return false;
+        origin = moved;
+        return true;
+    }
+};
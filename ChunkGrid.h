@@ -0,0 +1,103 @@
+#pragma once
+#include "Point.h"
+#include "GameConfig.h"
+#include <unordered_map>
+#include <memory>
+
+// Sparse width x height grid stored as CHUNK_SIZE x CHUNK_SIZE chunks.
+// A chunk is only allocated when one of its cells is written, reading a cell
+// of a missing chunk (or outside the grid) gives the fallback value.
+// Memory therefore grows with the area actually used, not with the grid size.
+// The last chunk looked up is cached, which makes neighboring lookups cheap;
+// because of that cache even const lookups must not run on two threads at once.
+template <typename T>
+class ChunkGrid {
+private:
+    struct Chunk {
+        T cells[CHUNK_SIZE * CHUNK_SIZE];
+    };
+
+    int width;
+    int height;
+    int chunksPerRow;
+    T fallback;
+    std::unordered_map<int, std::unique_ptr<Chunk>> chunks;
+
+    mutable int lastKey;
+    mutable Chunk* lastChunk;
+
+    int chunkKey(Point pos) const {
+        return (pos.getY() / CHUNK_SIZE) * chunksPerRow + pos.getX() / CHUNK_SIZE;
+    }
+
+    static int cellInChunk(Point pos) {
+        return (pos.getY() % CHUNK_SIZE) * CHUNK_SIZE + pos.getX() % CHUNK_SIZE;
+    }
+
+    Chunk* findChunk(int key) const {
+        if (key == lastKey) return lastChunk;
+        auto it = chunks.find(key);
+        if (it == chunks.end()) return nullptr;
+        lastKey = key;
+        lastChunk = it->second.get();
+        return lastChunk;
+    }
+
+public:
+    ChunkGrid(int w, int h, T fallbackValue)
+        : width(w), height(h), chunksPerRow((w + CHUNK_SIZE - 1) / CHUNK_SIZE),
+          fallback(fallbackValue), lastKey(-1), lastChunk(nullptr) {}
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChunkCount() const { return (int)chunks.size(); }
+
+    bool isInside(Point pos) const {
+        return pos.getX() >= 0 && pos.getX() < width && pos.getY() >= 0 && pos.getY() < height;
+    }
+
+    const T& get(Point pos) const {
+        if (!isInside(pos)) return fallback;
+        Chunk* chunk = findChunk(chunkKey(pos));
+        return chunk ? chunk->cells[cellInChunk(pos)] : fallback;
+    }
+
+    // Cells outside the grid are ignored
+    void set(Point pos, const T& value) {
+        if (!isInside(pos)) return;
+
+        int key = chunkKey(pos);
+        Chunk* chunk = findChunk(key);
+        if (!chunk) {
+            std::unique_ptr<Chunk> created(new Chunk);
+            for (T& cell : created->cells) {
+                cell = fallback;
+            }
+            chunk = created.get();
+            chunks[key] = std::move(created);
+            lastKey = key;
+            lastChunk = chunk;
+        }
+        chunk->cells[cellInChunk(pos)] = value;
+    }
+
+    // Frees the chunk holding pos, its cells read as the fallback again
+    void releaseChunk(Point pos) {
+        if (!isInside(pos)) return;
+        int key = chunkKey(pos);
+        if (key == lastKey) {
+            lastKey = -1;
+            lastChunk = nullptr;
+        }
+        chunks.erase(key);
+    }
+
+    // Back to all fallback, chunks stay allocated for reuse
+    void reset() {
+        for (auto& entry : chunks) {
+            for (T& cell : entry.second->cells) {
+                cell = fallback;
+            }
+        }
+    }
+};
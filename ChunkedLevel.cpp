@@ -0,0 +1,129 @@
+#include "ChunkedLevel.h"
+#include "Room.h"
+#include "GameConfig.h"
+#include <sstream>
+#include <algorithm>
+
+ChunkedLevel::ChunkedLevel() : width(0), height(0), legendPosition(2, 1) {}
+
+std::unique_ptr<ChunkedLevel> ChunkedLevel::open(const std::string& filename) {
+    std::unique_ptr<ChunkedLevel> level(new ChunkedLevel());
+    if (!level->index(filename)) {
+        return nullptr;
+    }
+    return level;
+}
+
+static void stripCarriageReturn(std::string& line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+}
+
+// One pass over the file: size line, legend, row offsets and switches, then the wiring
+bool ChunkedLevel::index(const std::string& filename) {
+    file.open(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    std::string line;
+    if (!std::getline(file, line)) return false;
+    
+    std::istringstream words(line);
+    std::string kind;
+    if (!(words >> kind >> width >> height) || kind != "size" || width <= 0 || height <= 0) {
+        return false;
+    }
+    
+    for (int y = 0; y < SCREEN_OFFSET_Y && std::getline(file, line); y++) {
+        size_t x = line.find('L');
+        if (x != std::string::npos) {
+            legendPosition = Point((int)x, y);
+        }
+    }
+    
+    rowStart.assign(height, 0);
+    rowLength.assign(height, 0);
+    for (int y = 0; y < height; y++) {
+        std::streamoff start = file.tellg();
+        if (!std::getline(file, line)) break;  // Missing rows stay empty
+        stripCarriageReturn(line);
+        
+        rowStart[y] = start;
+        rowLength[y] = std::min((int)line.length(), width);
+        for (int x = 0; x < rowLength[y]; x++) {
+            if (line[x] == '\\' || line[x] == '/') {
+                switchPositions.push_back(Point(x, y));
+            }
+        }
+    }
+    
+    while (std::getline(file, line)) {
+        stripCarriageReturn(line);
+        wiring.parseLine(line);
+    }
+    file.clear();  // Hit the end, keep the stream usable for seeking
+    return true;
+}
+
+void ChunkedLevel::registerSwitches(TriggerGraph& triggers) const {
+    for (const Point& pos : switchPositions) {
+        triggers.addSwitch(wiring.getSwitchGroup(pos), false);
+    }
+}
+
+std::string ChunkedLevel::readSpan(int y, int x, int count) {
+    std::string span(count, ' ');
+    if (y < 0 || y >= height) return span;
+    
+    int first = std::max(x, 0);
+    int last = std::min(x + count, rowLength[y]);
+    if (first >= last) return span;
+    
+    file.seekg(rowStart[y] + first);
+    file.read(&span[first - x], last - first);
+    file.clear();
+    return span;
+}
+
+char ChunkedLevel::charAt(Point pos) {
+    return readSpan(pos.getY(), pos.getX(), 1)[0];
+}
+
+void ChunkedLevel::loadChunk(Room& room, int chunkX, int chunkY) {
+    int startX = chunkX * CHUNK_SIZE;
+    int startY = chunkY * CHUNK_SIZE;
+    int endX = std::min(startX + CHUNK_SIZE, width);
+    int endY = std::min(startY + CHUNK_SIZE, height);
+    
+    // The chunk plus one column to the left and one row above, to find where springs start
+    int blockWidth = endX - startX + 1;
+    std::vector<std::string> block;
+    for (int y = startY - 1; y < endY; y++) {
+        block.push_back(readSpan(y, startX - 1, blockWidth));
+    }
+    
+    // Springs and the walls they lean on may reach into the next chunk
+    auto at = [&](Point pos) {
+        int bx = pos.getX() - (startX - 1);
+        int by = pos.getY() - (startY - 1);
+        if (bx >= 0 && bx < blockWidth && by >= 0 && by < (int)block.size()) {
+            return block[by][bx];
+        }
+        return charAt(pos);
+    };
+    auto isSpring = [&](Point pos) { return at(pos) == '#'; };
+    auto isWall = [&](Point pos) { return at(pos) == 'W'; };
+    auto markUsed = [](Point) {};
+    
+    for (int y = startY; y < endY; y++) {
+        for (int x = startX; x < endX; x++) {
+            Point pos(x, y);
+            char ch = at(pos);
+            if (ch != '#') {
+                room.addElementFromChar(ch, pos, wiring);
+            } else if (!isSpring(pos + Point(-1, 0)) && !isSpring(pos + Point(0, -1))) {
+                room.addElement(makeSpringRun(pos, isSpring, isWall, markUsed));
+            }
+        }
+    }
+}
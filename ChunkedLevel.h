@@ -0,0 +1,51 @@
+#pragma once
+#include "Point.h"
+#include "TriggerGraph.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Room;
+
+// Level file of a room larger than the screen:
+//   size <width> <height>
+//   3 legend lines ('L' marks the legend, like in a screen file)
+//   <height> map rows, same chars as a screen file
+//   wiring lines (see TriggerWiring), in room coordinates
+// Opening the file only records where each map row starts and where the
+// switches are. The map itself is read one CHUNK_SIZE x CHUNK_SIZE chunk at a
+// time, the first time the room needs it (see Room::loadChunkAt).
+// Springs are straight runs of '#' that don't touch each other: a '#' starts
+// one when the chars to its left and above it aren't '#'.
+class ChunkedLevel {
+private:
+    std::ifstream file;  // Open for the lifetime of the room
+    int width;
+    int height;
+    std::vector<std::streamoff> rowStart;  // File offset of each map row
+    std::vector<int> rowLength;
+    Point legendPosition;  // Screen coordinates
+    TriggerWiring wiring;
+    std::vector<Point> switchPositions;
+
+    ChunkedLevel();
+    bool index(const std::string& filename);
+    std::string readSpan(int y, int x, int count);  // Padded with ' ' outside the map
+    char charAt(Point pos);
+
+public:
+    // nullptr when the file isn't a large level (no "size" line first)
+    static std::unique_ptr<ChunkedLevel> open(const std::string& filename);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    Point getLegendPosition() const { return legendPosition; }
+    const TriggerWiring& getWiring() const { return wiring; }
+
+    // Counts every switch of the map into its group, loaded or not
+    void registerSwitches(TriggerGraph& triggers) const;
+
+    // Adds the elements of one chunk to the room
+    void loadChunk(Room& room, int chunkX, int chunkY);
+};
@@ -9,7 +9,7 @@ enum class Direction {
     RIGHT
 };
 
-inline Point directionToPoint(Direction dir) {
+constexpr Point directionToPoint(Direction dir) {
     switch (dir) {
         case Direction::UP: return Point(0, -1);
         case Direction::DOWN: return Point(0, 1);
@@ -0,0 +1,132 @@
+#include "DistanceField.h"
+#include "Room.h"
+#include "GameConfig.h"
+
+const int DistanceField::UNREACHABLE;
+
+// The cells are allocated by the first rebuild, rooms without enemies never need them
+DistanceField::DistanceField()
+    : origin(0, 0), layoutVersion(-1), room(nullptr) {}
+
+int DistanceField::cellIndex(Point pos) const {
+    int x = pos.getX() - origin.getX();
+    int y = pos.getY() - origin.getY();
+    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+        return -1;
+    }
+    return y * SCREEN_WIDTH + x;
+}
+
+Point DistanceField::cellPoint(int cell) const {
+    return Point(origin.getX() + cell % SCREEN_WIDTH, origin.getY() + cell / SCREEN_WIDTH);
+}
+
+void DistanceField::update(const Room* currentRoom, const std::vector<Point>& playerPositions,
+                           Point windowOrigin) {
+    if (currentRoom != room || currentRoom->getLayoutVersion() != layoutVersion ||
+        windowOrigin != origin || playerPositions.size() != sources.size()) {
+        room = currentRoom;
+        layoutVersion = currentRoom->getLayoutVersion();
+        origin = windowOrigin;
+        rebuild(playerPositions);
+        return;
+    }
+    
+    // Same walls, only repair around the players that moved
+    for (int i = 0; i < (int)sources.size(); i++) {
+        if (playerPositions[i] != sources[i]) {
+            moveSource(i, playerPositions[i]);
+        }
+    }
+}
+
+int DistanceField::getDistance(Point pos) const {
+    int cell = cellIndex(pos);
+    return (cell >= 0 && !dist.empty()) ? dist[cell] : UNREACHABLE;
+}
+
+void DistanceField::rebuild(const std::vector<Point>& newSources) {
+    sources = newSources;
+    if (dist.empty()) {
+        dist.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+        owner.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+    }
+    for (int cell = 0; cell < (int)dist.size(); cell++) {
+        dist[cell] = UNREACHABLE;
+        owner[cell] = -1;
+    }
+    
+    for (int i = 0; i < (int)sources.size(); i++) {
+        int cell = cellIndex(sources[i]);
+        if (cell >= 0 && dist[cell] > 0) {
+            dist[cell] = 0;
+            owner[cell] = i;
+            push(cell, 0);
+        }
+    }
+    propagate();
+}
+
+void DistanceField::moveSource(int source, Point newPos) {
+    sources[source] = newPos;
+    
+    // Forget every cell this source was the nearest for
+    resetCells.clear();
+    for (int cell = 0; cell < (int)owner.size(); cell++) {
+        if (owner[cell] == source) {
+            dist[cell] = UNREACHABLE;
+            owner[cell] = -1;
+            resetCells.push_back(cell);
+        }
+    }
+    
+    // The cells around that hole still have correct distances, grow back from them
+    for (int cell : resetCells) {
+        Point pos = cellPoint(cell);
+        for (int d = 1; d <= 4; d++) {
+            int next = cellIndex(pos + directionToPoint((Direction)d));
+            if (next >= 0 && owner[next] >= 0) {
+                push(next, dist[next]);
+            }
+        }
+    }
+    
+    // And from the new position, which also takes over cells it's now closer to
+    int cell = cellIndex(newPos);
+    if (cell >= 0 && dist[cell] > 0) {
+        dist[cell] = 0;
+        owner[cell] = source;
+        push(cell, 0);
+    }
+    propagate();
+}
+
+void DistanceField::push(int cell, int distance) {
+    if ((int)buckets.size() <= distance) {
+        buckets.resize(distance + 1);
+    }
+    buckets[distance].push_back(cell);
+}
+
+// Dial's algorithm: pop cells in order of distance, relax the walkable neighbors
+void DistanceField::propagate() {
+    for (int d = 0; d < (int)buckets.size(); d++) {
+        for (int k = 0; k < (int)buckets[d].size(); k++) {
+            int cell = buckets[d][k];
+            if (dist[cell] != d) continue;  // Improved since it was queued
+            
+            Point pos = cellPoint(cell);
+            for (int dir = 1; dir <= 4; dir++) {
+                Point nextPos = pos + directionToPoint((Direction)dir);
+                int next = cellIndex(nextPos);
+                if (next < 0 || dist[next] <= d + 1 || !room->isPositionWalkable(nextPos)) {
+                    continue;
+                }
+                dist[next] = d + 1;
+                owner[next] = owner[cell];
+                push(next, d + 1);
+            }
+        }
+        buckets[d].clear();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Point.h"
+#include "Direction.h"
+#include <vector>
+
+class Room;
+
+// Distance from every cell to the nearest player (flow field), shared by all
+// enemies in a room. Built by BFS over the walkable cells.
+// When only players moved, just the cells that belonged to a moved player
+// (its Voronoi region) and the cells it now reaches faster are repaired;
+// a full rebuild only happens when the room layout changes or the window
+// (a screen-sized part of the room, see Camera) scrolls.
+class DistanceField {
+private:
+    std::vector<int> dist;    // cell -> steps to nearest source
+    std::vector<int> owner;   // cell -> index of that source, -1 = unreachable
+    std::vector<Point> sources;
+    Point origin;  // Top-left corner of the window in room coordinates
+    int layoutVersion;
+    const Room* room;
+    
+    // Scratch, reused between updates
+    std::vector<std::vector<int>> buckets;  // Dial's bucket queue
+    std::vector<int> resetCells;
+    
+    int cellIndex(Point pos) const;  // -1 outside the window
+    Point cellPoint(int cell) const;
+    void rebuild(const std::vector<Point>& newSources);
+    void moveSource(int source, Point newPos);
+    void push(int cell, int distance);
+    void propagate();
+    
+public:
+    static const int UNREACHABLE = 1 << 30;
+    
+    DistanceField();
+    
+    // Bring the field up to date with the room, the window and the player positions
+    void update(const Room* currentRoom, const std::vector<Point>& playerPositions,
+                Point windowOrigin = Point(0, 0));
+    
+    int getDistance(Point pos) const;  // UNREACHABLE outside the window
+    
+    // The next update rebuilds, for a field that rooms take turns using
+    void invalidate() { room = nullptr; }
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "LevelTable.h"
+#include <array>
+
+// Levels compiled into kiosk builds (KIOSK_BUILD), so the game starts
+// without touching the disk. The Kiosk configuration of the project writes
+// every adv-world_*.screen into EmbeddedLevels.inc as a raw string literal
+// before compiling. The screens are parsed here at compile time into
+// read-only element tables (LevelTable.h).
+// A broken screen stops the build with the reason in the error message.
+namespace EmbeddedLevels {
+    constexpr const char* SCREENS[] = {
+#include "EmbeddedLevels.inc"
+    };
+    constexpr int LEVEL_COUNT = (int)(sizeof(SCREENS) / sizeof(SCREENS[0]));
+
+    constexpr std::array<LevelTable, LEVEL_COUNT> parseLevels() {
+        std::array<LevelTable, LEVEL_COUNT> levels{};
+        for (int i = 0; i < LEVEL_COUNT; i++) {
+            levels[i] = parseLevel(SCREENS[i]);
+        }
+        return levels;
+    }
+
+    // The tables, filled in by the compiler
+    constexpr std::array<LevelTable, LEVEL_COUNT> LEVELS = parseLevels();
+}
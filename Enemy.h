@@ -0,0 +1,27 @@
+#pragma once
+#include "GameElement.h"
+
+// Moving hazard that chases the nearest player (see Room::updateEnemies)
+class Enemy : public GameElement {
+private:
+    Point spawn;   // Where it goes back to after hitting a player
+    int cooldown;  // Cycles until it may move again
+    
+public:
+    Enemy(Point pos) : GameElement(pos, 'E'), spawn(pos), cooldown(0) {}
+    
+    bool canPlayerPass() const override { return true; }  // Walking into an enemy hurts
+    
+    Point getSpawn() const { return spawn; }
+    
+    // Counts down the cooldown, returns true when the enemy may move this cycle
+    bool isReady() {
+        if (cooldown > 0) {
+            cooldown--;
+            return false;
+        }
+        return true;
+    }
+    int getCooldown() const { return cooldown; }
+    void setCooldown(int cycles) { cooldown = cycles; }
+};
@@ -0,0 +1,105 @@
+#include "FieldOfView.h"
+#include "Room.h"
+#include "GameConfig.h"
+
+// Division rounding towards -infinity / +infinity (den > 0)
+static int floorDiv(int num, int den) {
+    return num >= 0 ? num / den : -((-num + den - 1) / den);
+}
+
+static int ceilDiv(int num, int den) {
+    return num >= 0 ? (num + den - 1) / den : -((-num) / den);
+}
+
+FieldOfView::FieldOfView()
+    : visible(SCREEN_WIDTH, SCREEN_HEIGHT),
+      room(nullptr), radius(0), layoutVersion(-1), valid(false) {}
+
+bool FieldOfView::update(const Room* currentRoom, Point viewer, int lightRadius) {
+    if (currentRoom != room) {
+        if (visible.getWidth() != currentRoom->getWidth() || visible.getHeight() != currentRoom->getHeight()) {
+            visible = BitGrid(currentRoom->getWidth(), currentRoom->getHeight());
+        }
+        valid = false;
+    }
+
+    if (valid && viewer == origin && lightRadius == radius &&
+        currentRoom->getLayoutVersion() == layoutVersion) {
+        return false;  // Nothing changed, keep the cached view
+    }
+
+    room = currentRoom;
+    origin = viewer;
+    radius = lightRadius;
+    layoutVersion = currentRoom->getLayoutVersion();
+    valid = true;
+
+    compute();
+    return true;
+}
+
+void FieldOfView::compute() {
+    visible.clear();
+    reveal(origin);
+
+    // North, east, south, west quadrants
+    for (int quadrant = 0; quadrant < 4; quadrant++) {
+        scanRow(quadrant, 1, Slope{ -1, 1 }, Slope{ 1, 1 });
+    }
+}
+
+Point FieldOfView::toRoom(int quadrant, int depth, int col) const {
+    switch (quadrant) {
+        case 0: return Point(origin.getX() + col, origin.getY() - depth);
+        case 1: return Point(origin.getX() + depth, origin.getY() + col);
+        case 2: return Point(origin.getX() + col, origin.getY() + depth);
+        default: return Point(origin.getX() - depth, origin.getY() + col);
+    }
+}
+
+void FieldOfView::reveal(Point pos) {
+    int dx = pos.getX() - origin.getX();
+    int dy = pos.getY() - origin.getY();
+    if (dx * dx + dy * dy > radius * radius + radius) return;  // Outside the light circle
+
+    visible.set(pos);
+}
+
+// One row of a quadrant, cells from min to max col, recursing into the next row
+// for every lit gap (see "Symmetric Shadowcasting" by Albert Ford)
+void FieldOfView::scanRow(int quadrant, int depth, Slope start, Slope end) {
+    if (depth > radius) return;
+
+    // round_ties_up(depth * start) and round_ties_down(depth * end)
+    int minCol = floorDiv(2 * depth * start.num + start.den, 2 * start.den);
+    int maxCol = ceilDiv(2 * depth * end.num - end.den, 2 * end.den);
+
+    bool prevIsWall = false;
+    bool hasPrev = false;
+
+    for (int col = minCol; col <= maxCol; col++) {
+        Point pos = toRoom(quadrant, depth, col);
+        bool isWall = room->blocksSight(pos);
+
+        // Floor cells are only lit when they are symmetric (center inside the sector)
+        bool symmetric = col * start.den >= depth * start.num && col * end.den <= depth * end.num;
+        if (isWall || symmetric) {
+            reveal(pos);
+        }
+
+        Slope tileSlope{ 2 * col - 1, 2 * depth };
+        if (hasPrev && prevIsWall && !isWall) {
+            start = tileSlope;
+        }
+        if (hasPrev && !prevIsWall && isWall) {
+            scanRow(quadrant, depth + 1, start, tileSlope);
+        }
+
+        prevIsWall = isWall;
+        hasPrev = true;
+    }
+
+    if (hasPrev && !prevIsWall) {
+        scanRow(quadrant, depth + 1, start, end);
+    }
+}
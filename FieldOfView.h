@@ -0,0 +1,41 @@
+#pragma once
+#include "Point.h"
+#include "BitGrid.h"
+
+class Room;
+
+// What one player can see, using symmetric shadowcasting over the room's
+// sight-blocking cells (walls and obstacles).
+// The result is cached and only recomputed when the player moves, the light
+// radius changes, or the room's layout changes (see Room::getLayoutVersion).
+// What was seen before is kept by the caller (Game keeps it per room).
+class FieldOfView {
+private:
+    // Integer fraction for the shadowcasting slopes (den is always > 0)
+    struct Slope {
+        int num;
+        int den;
+    };
+
+    BitGrid visible;
+
+    const Room* room;
+    Point origin;
+    int radius;
+    int layoutVersion;
+    bool valid;
+
+    void compute();
+    void scanRow(int quadrant, int depth, Slope start, Slope end);
+    Point toRoom(int quadrant, int depth, int col) const;
+    void reveal(Point pos);
+
+public:
+    FieldOfView();
+
+    // Returns true if the view had to be recomputed
+    bool update(const Room* currentRoom, Point viewer, int lightRadius);
+    void invalidate() { valid = false; }
+
+    const BitGrid& getVisible() const { return visible; }
+};
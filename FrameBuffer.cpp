@@ -0,0 +1,44 @@
+#include "FrameBuffer.h"
+#include <iostream>
+#include <algorithm>
+
+FrameBuffer::FrameBuffer() : FrameBuffer(SCREEN_WIDTH, SCREEN_OFFSET_Y + SCREEN_HEIGHT) {}
+
+FrameBuffer::FrameBuffer(int frameWidth, int frameHeight)
+    : width(frameWidth), height(frameHeight),
+      cells(width * height, ' '), priorities(width * height, DRAW_PRIORITY_FLOOR) {}
+
+void FrameBuffer::clear() {
+    std::fill(cells.begin(), cells.end(), ' ');
+    std::fill(priorities.begin(), priorities.end(), (char)DRAW_PRIORITY_FLOOR);
+}
+
+void FrameBuffer::plot(int x, int y, char ch, int priority) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    int cell = y * width + x;
+    if (priority >= priorities[cell]) {
+        cells[cell] = ch;
+        priorities[cell] = (char)priority;
+    }
+}
+
+void FrameBuffer::print(int x, int y, const char* text) {
+    for (int i = 0; text[i]; i++) {
+        plot(x + i, y, text[i], DRAW_PRIORITY_PLAYER);
+    }
+}
+
+char FrameBuffer::getCharAt(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) return ' ';
+    return cells[y * width + x];
+}
+
+// Every row is overwritten, so there's no need to clear the console first (no flicker)
+void FrameBuffer::presentCells(const char* cells, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        gotoxy(0, y);
+        std::cout.write(cells + y * width, width);
+    }
+    std::cout.flush();
+}
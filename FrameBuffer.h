@@ -0,0 +1,67 @@
+#pragma once
+#include "GameConfig.h"
+#include <vector>
+#include <string>
+
+// Draw priority of a char, used when several room cells land on one screen
+// cell (downsampled viewports): players beat items beat walls beat floor
+const int DRAW_PRIORITY_FLOOR = 0;
+const int DRAW_PRIORITY_WALL = 1;
+const int DRAW_PRIORITY_ITEM = 2;
+const int DRAW_PRIORITY_PLAYER = 3;
+
+inline int getDrawPriority(char ch) {
+    if (ch == ' ') return DRAW_PRIORITY_FLOOR;
+    if (ch == Chars::WALL) return DRAW_PRIORITY_WALL;
+    return DRAW_PRIORITY_ITEM;
+}
+
+// Part of the screen showing a screen-sized window of one room (the camera,
+// top-left corner in room coordinates), scaled to width x height cells
+struct Viewport {
+    int x;
+    int y;
+    int width;
+    int height;
+    int cameraX;
+    int cameraY;
+
+    int mapX(int roomX) const { return x + (roomX - cameraX) * width / SCREEN_WIDTH; }
+    int mapY(int roomY) const { return y + (roomY - cameraY) * height / SCREEN_HEIGHT; }
+
+    bool shows(int roomX, int roomY) const {
+        return roomX >= cameraX && roomX < cameraX + SCREEN_WIDTH &&
+               roomY >= cameraY && roomY < cameraY + SCREEN_HEIGHT;
+    }
+};
+
+// Whole console frame (legend lines + play area), composed in memory and
+// written out in one pass instead of clearing the screen and drawing element by element
+class FrameBuffer {
+private:
+    int width;
+    int height;
+    std::vector<char> cells;
+    std::vector<char> priorities;
+
+public:
+    FrameBuffer();  // Legend lines + play area
+    FrameBuffer(int frameWidth, int frameHeight);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void clear();
+
+    // Keeps the existing char if it has a higher priority
+    void plot(int x, int y, char ch, int priority);
+    void print(int x, int y, const char* text);  // Legend text, always wins
+    void print(int x, int y, const std::string& text) { print(x, y, text.c_str()); }
+
+    char getCharAt(int x, int y) const;
+    const char* getCells() const { return cells.data(); }  // Row by row, width * height
+    void present() const { presentCells(cells.data(), width, height); }
+    
+    // Writes width x height cells (row by row) over the console
+    static void presentCells(const char* cells, int width, int height);
+};
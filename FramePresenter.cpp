@@ -0,0 +1,51 @@
+#include "FramePresenter.h"
+#include "AllocTracker.h"
+#include <cstring>
+
+FramePresenter::FramePresenter()
+    : submitted(0), presented(0), presentedAt(0), skipped(0), running(true),
+      wakeEvent(CreateEventA(nullptr, FALSE, FALSE, nullptr)) {
+    renderer = std::thread(&FramePresenter::renderLoop, this);
+}
+
+FramePresenter::~FramePresenter() {
+    running.store(false, std::memory_order_release);
+    SetEvent(wakeEvent);
+    renderer.join();
+    CloseHandle(wakeEvent);
+}
+
+uint32_t FramePresenter::submit(const FrameBuffer& frame) {
+    FrameSnapshot& snapshot = snapshots.getBack();
+    std::memcpy(snapshot.cells, frame.getCells(), sizeof(snapshot.cells));
+    snapshot.number = ++submitted;
+    snapshots.publish();
+    SetEvent(wakeEvent);
+    return submitted;
+}
+
+void FramePresenter::flush() {
+    while (presented.load(std::memory_order_acquire) != submitted) {
+        Sleep(1);
+    }
+}
+
+void FramePresenter::renderLoop() {
+    AllocTracker::setSubsystem(AllocSubsystem::PRESENTER);
+    uint32_t last = 0;
+    while (running.load(std::memory_order_acquire)) {
+        const FrameSnapshot* snapshot = snapshots.takeNewest();
+        if (!snapshot) {
+            WaitForSingleObject(wakeEvent, INFINITE);
+            continue;
+        }
+        
+        if (snapshot->number > last + 1) {
+            skipped.fetch_add(snapshot->number - last - 1, std::memory_order_relaxed);
+        }
+        FrameBuffer::presentCells(snapshot->cells, SCREEN_WIDTH, SCREEN_HEIGHT + SCREEN_OFFSET_Y);
+        last = snapshot->number;
+        presentedAt.store(((uint64_t)last << 32) | getMicroseconds(), std::memory_order_release);
+        presented.store(last, std::memory_order_release);
+    }
+}
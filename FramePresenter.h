@@ -0,0 +1,54 @@
+#pragma once
+#include "GameConfig.h"
+#include "FrameBuffer.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+// Copy of a composed frame, legend included, as handed to the render thread
+struct FrameSnapshot {
+    uint32_t number;  // Counts up from 1 with every submitted frame
+    char cells[SCREEN_WIDTH * (SCREEN_HEIGHT + SCREEN_OFFSET_Y)];
+};
+
+// Writes frames to the console on its own thread, so a slow console doesn't
+// stretch the game cycle. submit() copies the frame into a triple buffer and
+// returns, the render thread wakes up and presents the newest snapshot,
+// frames that came in while it was still writing are skipped.
+class FramePresenter {
+private:
+    TripleBuffer<FrameSnapshot> snapshots;
+    uint32_t submitted;                 // Game thread only
+    std::atomic<uint32_t> presented;    // Number of the last frame fully written
+    std::atomic<uint64_t> presentedAt;  // Its number (high half) and getMicroseconds() when done
+    std::atomic<uint32_t> skipped;
+    std::atomic<bool> running;
+    HANDLE wakeEvent;
+    std::thread renderer;
+
+    void renderLoop();
+
+public:
+    FramePresenter();
+    ~FramePresenter();
+
+    // Prevent copying (owns the render thread)
+    FramePresenter(const FramePresenter&) = delete;
+    FramePresenter& operator=(const FramePresenter&) = delete;
+
+    // Game thread, never waits for the console. Returns the frame's number.
+    uint32_t submit(const FrameBuffer& frame);
+
+    // Waits until the last submitted frame is on the console. Call before
+    // writing to the console directly (pause menu, end of game).
+    void flush();
+
+    // Last frame written to the console and when it was done
+    void getLastPresented(uint32_t& number, uint32_t& at) const {
+        uint64_t value = presentedAt.load(std::memory_order_acquire);
+        number = (uint32_t)(value >> 32);
+        at = (uint32_t)value;
+    }
+    uint32_t getSkippedCount() const { return skipped.load(std::memory_order_relaxed); }
+};
@@ -9,19 +9,111 @@
 #include "Riddle.h"
 #include "Switch.h"
 #include "Spring.h"
+#include "Enemy.h"
+#include "AllocTracker.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <thread>
+#ifdef KIOSK_BUILD
+#include "EmbeddedLevels.h"
+#endif
 
-Game::Game() 
-    : currentRoomIndex(0), player1ReachedEnd(false), player2ReachedEnd(false), 
+Game::Game(int numPlayers, SharedLevels* levels)
+    : playerCount(std::max(1, std::min(numPlayers, MAX_PLAYERS))),
+      headless(levels != nullptr), sharedLevels(levels), furthestRoomIndex(0),
       state(GameState::MENU), activeRiddle(nullptr), riddlePlayer(nullptr),
-      lives(3), score(0) {
-    player1 = std::make_unique<Player>(Point(5, 10), Chars::PLAYER1);
-    player2 = std::make_unique<Player>(Point(5, 12), Chars::PLAYER2);
+      riddleAnswer(Keys::SOLVE_RIDDLE), riddleAsked(false), lives(3), score(0), autopilotSetting(0), darkMode(false),
+      // The game thread helps too, headless games share their host's thread
+      roomWorkers(levels ? 0 : std::max(1, (int)std::thread::hardware_concurrency()) - 1),
+      frame(levels ? 0 : SCREEN_WIDTH, levels ? 0 : SCREEN_OFFSET_Y + SCREEN_HEIGHT),
+      continueFromSave(false),
+      rewindBuffer(levels ? 0 : REWIND_TICKS, REWIND_KEYFRAME_INTERVAL),  // Headless games don't rewind
+      telemetryTick(0), showLatency(false), scriptMessageTicks(0) {
+    if (headless) {
+        createPlayers();  // Default keys
+        loadRooms();
+        return;
+    }
+    
+#ifdef KIOSK_BUILD
+    createPlayers();  // Kiosk builds use the default keys and the built-in levels
+    loadRooms();
+#else
+    keyMap.loadFromFile(KEYMAP_FILE);
+    createPlayers();
+    loadRooms();
+    screenWatcher = std::make_unique<ScreenWatcher>();
+    screenWatcher->start(".", ".screen");  // Screen files are looked up in the current directory
+#endif
+    telemetry = std::make_unique<Telemetry>(TELEMETRY_FILE);
+    presenter = std::make_unique<FramePresenter>();
+    latency = std::make_unique<LatencyTracker>();
+    spectatorFrame = std::make_unique<SharedFramePublisher>();
+}
+
+Game::~Game() {
+    if (saveThread.joinable()) {
+        saveThread.join();  // Don't lose a save that is still being written
+    }
+}
+
+void Game::createPlayers() {
+    players.clear();
+    for (int i = 0; i < playerCount; i++) {
+        players.push_back(std::make_unique<Player>(getSpawnPoint(i), Chars::PLAYER_SYMBOLS[i]));
+    }
+    moveResolver.reserve(playerCount);
+    heldItems.reserve(playerCount);  // The first pick-up mid-game doesn't allocate
+}
+
+Point Game::getSpawnPoint(int playerIndex) const {
+    return getPlayerSpawnPoint(playerIndex);
+}
+
+// Takes effect with the next game (a saved game only loads with the count it was saved with)
+void Game::setPlayerCount(int count) {
+    bool allBots = autopilotSetting == playerCount + 1;
+    playerCount = std::max(1, std::min(count, MAX_PLAYERS));
+    if (allBots) {
+        autopilotSetting = playerCount + 1;
+    } else if (autopilotSetting > playerCount) {
+        autopilotSetting = 0;
+    }
+    createPlayers();
+}
+
+void Game::createAutopilots() {
+    autopilots.clear();
+    for (int i = 0; i < playerCount; i++) {
+        // Players nobody has keys for can't be played from the keyboard
+        bool isBot = autopilotSetting == i + 1 || autopilotSetting == playerCount + 1 || !keyMap.hasKeys(i);
+        autopilots.push_back(isBot ? std::make_unique<Autopilot>() : nullptr);
+    }
+}
+
+bool Game::allPlayersReachedEnd() const {
+    for (const auto& player : players) {
+        if (!player->hasReachedEnd()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Game::loadRooms() {
+    scripts.clear();
+    if (sharedLevels) {
+        loadRoomsFromTables(sharedLevels->tables.data(), (int)sharedLevels->tables.size());
+        return;
+    }
+#ifdef KIOSK_BUILD
+    loadRoomsFromTables(EmbeddedLevels::LEVELS.data(), EmbeddedLevels::LEVEL_COUNT);
+#else
     loadRoomsFromFiles();
+#endif
 }
 
 void Game::loadRoomsFromFiles() {
@@ -48,24 +140,51 @@ void Game::loadRoomsFromFiles() {
     // Load each screen file
     int roomId = 1;
     for (const auto& filename : screenFiles) {
+        // Determine if this is the final room (last file in the list)
+        bool isFinalRoom = (roomId == (int)screenFiles.size());
+        
+        // Rooms larger than the screen are read chunk by chunk while playing
+        if (std::unique_ptr<ChunkedLevel> level = ChunkedLevel::open(filename)) {
+            auto room = std::make_unique<Room>(roomId, isFinalRoom, level->getWidth(), level->getHeight());
+            legendPositions.push_back(level->getLegendPosition());
+            screenSources.push_back(ScreenSource());
+            room->setLevel(std::move(level));
+            rooms.push_back(std::move(room));
+            loadRoomScript((int)rooms.size() - 1, filename);
+            roomId++;
+            continue;
+        }
+        
         std::ifstream file(filename);
         if (!file.is_open()) {
             std::cerr << "Error: Could not open " << filename << std::endl;
             continue;
         }
         
-        // Determine if this is the final room (last file in the list)
-        bool isFinalRoom = (roomId == (int)screenFiles.size());
         auto room = std::make_unique<Room>(roomId, isFinalRoom);
         
         Point legendPos(2, 1);  // Default legend position
         bool legendFound = false;
         
-        // Read the file line by line (28 lines: 3 for legend area + 25 for game area)
+        // Read the whole file: 28 lines (3 for legend area + 25 for game area),
+        // followed by optional trigger wiring lines
+        std::vector<std::string> lines;
         std::string line;
-        int y = 0;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        
         const int TOTAL_LINES = SCREEN_OFFSET_Y + SCREEN_HEIGHT;  // 3 + 25 = 28
-        while (std::getline(file, line) && y < TOTAL_LINES) {
+        TriggerWiring wiring;
+        for (int i = TOTAL_LINES; i < (int)lines.size(); i++) {
+            wiring.parseLine(lines[i]);
+        }
+        
+        // Spring chars already merged into a spring
+        std::vector<bool> springUsed(TOTAL_LINES * SCREEN_WIDTH, false);
+        
+        for (int y = 0; y < TOTAL_LINES && y < (int)lines.size(); y++) {
+            line = lines[y];
             // Pad or truncate line to SCREEN_WIDTH
             if (line.length() < SCREEN_WIDTH) {
                 line.resize(SCREEN_WIDTH, ' ');
@@ -80,91 +199,34 @@ void Game::loadRoomsFromFiles() {
                 // adjust position to game coordinates (0-24)
                 Point gamePos(x, y >= SCREEN_OFFSET_Y ? y - SCREEN_OFFSET_Y : y);
                 
-                switch (ch) {
-                    case 'W':  // Wall
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Wall>(gamePos));
-                        }
-                        break;
-                    
-                    case 'K':  // Key
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Key>(gamePos));
-                        }
-                        break;
-                    
-                    case '!':  // Torch
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Torch>(gamePos));
-                        }
-                        break;
-                    
-                    case '@':  // Bomb
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Bomb>(gamePos));
-                        }
-                        break;
-                    
-                    case '*':  // Obstacle
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Obstacle>(gamePos));
-                        }
-                        break;
-                    
-                    case '?':  // Riddle
-                        if (y >= SCREEN_OFFSET_Y) {
-                            room->addElement(std::make_unique<Riddle>(gamePos));
-                        }
-                        break;
-                    
-                    case '\\':  // Switch (OFF state)
-                    case '/':   // Switch (ON state) - treat same as OFF initially
-                        if (y >= SCREEN_OFFSET_Y) {
-                            // For now, all switches belong to group 0
-                            room->addElement(std::make_unique<Switch>(gamePos, 0));
-                        }
-                        break;
-                    
-                    case '#':  // Spring
-                        if (y >= SCREEN_OFFSET_Y) {
-                            // Determine spring direction based on surrounding springs
-                            // For now, create horizontal spring (will be adjusted later)
-                            room->addElement(std::make_unique<Spring>(gamePos, Direction::RIGHT, 1));
-                        }
-                        break;
-                    
-                    case 'L':  // Legend position marker (keep file coordinates)
-                        legendPos = pos;
-                        legendFound = true;
-                        break;
-                    
-                    case ' ':  // Empty space
-                    case '.':  // Alternative empty space marker
-                        // Walkable, no element needed
-                        break;
-                    
-                    default:
-                        // Check if it's a door number (1-9)
-                        if (ch >= '1' && ch <= '9') {
-                            if (y >= SCREEN_OFFSET_Y) {
-                                int targetRoom = ch - '0';
-                                room->addElement(std::make_unique<Door>(gamePos, roomId, targetRoom));
-                            }
-                        }
-                        // Otherwise ignore unknown characters
-                        break;
+                if (ch == 'L') {
+                    // Legend position marker (keep file coordinates)
+                    legendPos = pos;
+                    legendFound = true;
+                } else if (y >= SCREEN_OFFSET_Y) {
+                    if (ch == '#') {
+                        addSpringAt(room.get(), lines, x, y, springUsed);
+                    } else {
+                        room->addElementFromChar(ch, gamePos, wiring);
+                    }
                 }
             }
-            y++;
+        }
+        
+        // Wire group actions (walls, bombs) now that all elements exist
+        for (const TriggerWiring::ActionEntry& entry : wiring.actions) {
+            room->addTrigger(entry.group, entry.action);
         }
         
         file.close();
         
         // Store legend position for this room
         legendPositions.push_back(legendPos);
+        screenSources.push_back({ filename, lines, wiring });
         
         // Add room to the game
         rooms.push_back(std::move(room));
+        loadRoomScript((int)rooms.size() - 1, filename);
         roomId++;
     }
     
@@ -184,7 +246,171 @@ void Game::loadRoomsFromFiles() {
         
         rooms.push_back(std::move(finalRoom));
         legendPositions.push_back(Point(2, 1));
+        screenSources.push_back(ScreenSource());
+    }
+}
+
+// adv-world_NN.script next to the screen, a room without one has no script
+void Game::loadRoomScript(int roomIndex, const std::string& screenFile) {
+    std::string filename = screenFile.substr(0, screenFile.rfind('.')) + ".script";
+    std::ifstream file(filename);
+    if (!file.is_open()) return;
+    
+    std::stringstream source;
+    source << file.rdbuf();
+    ScriptProgram program;
+    std::string error;
+    if (!program.compile(source.str(), error)) {
+        std::cerr << "Error: " << filename << " " << error << std::endl;
+        return;
+    }
+    scripts.setProgram(roomIndex, std::move(program));
+}
+
+// Rooms straight from parsed tables (built-in or shared levels), nothing is read or parsed here.
+// Shared levels bring their walls along, the rooms only get the other elements.
+void Game::loadRoomsFromTables(const LevelTable* tables, int count) {
+    for (int i = 0; i < count; i++) {
+        const LevelTable& level = tables[i];
+        auto room = sharedLevels ?
+            std::make_unique<Room>(i + 1, i == count - 1, &sharedLevels->layouts[i], &sharedLevels->flowField) :
+            std::make_unique<Room>(i + 1, i == count - 1);
+        
+        for (int r = 0; r < level.recordCount; r++) {
+            room->addElementFromRecord(level.records[r]);
+        }
+        for (int a = 0; a < level.actionCount; a++) {
+            room->addTrigger(level.actions[a].group, level.actions[a].action);
+        }
+        
+        legendPositions.push_back(level.legendPos);
+        rooms.push_back(std::move(room));
+    }
+}
+
+// Char at file column x, line y (space when outside the file)
+static char screenCharAt(const std::vector<std::string>& lines, int x, int y) {
+    if (y < 0 || y >= (int)lines.size() || x < 0 || x >= (int)lines[y].length()) {
+        return ' ';
+    }
+    return lines[y][x];
+}
+
+// Merges the run of '#' starting at file position (x, y) into one spring.
+// The scan goes left to right, top to bottom, so (x, y) is always the left or top end.
+// The spring launches away from the wall it leans on.
+void Game::addSpringAt(Room* room, const std::vector<std::string>& lines, int x, int y,
+                       std::vector<bool>& springUsed) {
+    if (springUsed[y * SCREEN_WIDTH + x]) return;
+    
+    // Play coordinates -> file coordinates
+    auto isFreeSpring = [&](Point p) {
+        int cx = p.getX(), cy = p.getY() + SCREEN_OFFSET_Y;
+        return cx < SCREEN_WIDTH && cy < SCREEN_OFFSET_Y + SCREEN_HEIGHT &&
+               screenCharAt(lines, cx, cy) == '#' && !springUsed[cy * SCREEN_WIDTH + cx];
+    };
+    auto isWallChar = [&](Point p) {
+        return screenCharAt(lines, p.getX(), p.getY() + SCREEN_OFFSET_Y) == 'W';
+    };
+    auto markUsed = [&](Point p) {
+        springUsed[(p.getY() + SCREEN_OFFSET_Y) * SCREEN_WIDTH + p.getX()] = true;
+    };
+    
+    room->addElement(makeSpringRun(Point(x, y - SCREEN_OFFSET_Y), isFreeSpring, isWallChar, markUsed));
+}
+
+// Applies edits of the screen files the rooms were loaded from. Only rooms
+// whose file changed are touched, and only in the cells that differ.
+void Game::reloadChangedScreens() {
+    if (!screenWatcher) return;
+    
+    std::vector<std::string> changedFiles;
+    bool checkAll = screenWatcher->poll(changedFiles);
+    if (changedFiles.empty() && !checkAll) return;
+    AllocTracker::restartWarmup();  // Reading and patching the files allocates
+    
+    const int TOTAL_LINES = SCREEN_OFFSET_Y + SCREEN_HEIGHT;
+    for (int i = 0; i < (int)screenSources.size(); i++) {
+        const std::string& filename = screenSources[i].filename;
+        if (filename.empty()) continue;
+        if (!checkAll && std::find(changedFiles.begin(), changedFiles.end(), filename) == changedFiles.end()) {
+            continue;
+        }
+        
+        std::ifstream file(filename);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        
+        // Editors may save in several writes, the last one completes the file
+        if ((int)lines.size() < TOTAL_LINES) continue;
+        patchRoom(i, lines);
+    }
+}
+
+// Replaces what differs between the old and the new text of a room's screen.
+// A changed cell loses the element standing on it and gets the new char's
+// element, everything else (players, held items, moved obstacles, bomb
+// timers) stays as it is. Springs next to a changed '#' are merged again.
+// Wiring lines are read when a new game starts.
+void Game::patchRoom(int roomIndex, const std::vector<std::string>& newLines) {
+    ScreenSource& source = screenSources[roomIndex];
+    Room* room = rooms[roomIndex].get();
+    const int TOTAL_LINES = SCREEN_OFFSET_Y + SCREEN_HEIGHT;
+    bool springsChanged = false;
+    
+    for (int y = 0; y < TOTAL_LINES; y++) {
+        if (y < (int)source.lines.size() && source.lines[y] == newLines[y]) continue;
+        
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            char oldCh = screenCharAt(source.lines, x, y);
+            char newCh = screenCharAt(newLines, x, y);
+            if (oldCh == newCh) continue;
+            
+            if (newCh == 'L') {
+                legendPositions[roomIndex] = Point(x, y);
+            } else if (oldCh == 'L' && legendPositions[roomIndex] == Point(x, y)) {
+                legendPositions[roomIndex] = Point(2, 1);  // Default legend position
+            }
+            if (y < SCREEN_OFFSET_Y) continue;
+            
+            Point pos(x, y - SCREEN_OFFSET_Y);
+            if (oldCh == '#' || newCh == '#') {
+                // The neighboring springs may grow, shrink or split
+                for (Point cell : { pos, pos + Point(1, 0), pos + Point(-1, 0), pos + Point(0, 1), pos + Point(0, -1) }) {
+                    if (Spring* spring = room->getSpringAt(cell)) {
+                        room->markElementAsCollected(spring);
+                    }
+                }
+                springsChanged = true;
+            }
+            if (GameElement* element = room->getElementAt(pos)) {
+                room->markElementAsCollected(element);
+            }
+            room->addElementFromChar(newCh, pos, source.wiring);
+        }
     }
+    
+    if (springsChanged) {
+        // Cells of the springs still standing are taken, the rest is merged again
+        std::vector<bool> springUsed(TOTAL_LINES * SCREEN_WIDTH, false);
+        for (int y = SCREEN_OFFSET_Y; y < TOTAL_LINES; y++) {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                springUsed[y * SCREEN_WIDTH + x] = room->getSpringAt(Point(x, y - SCREEN_OFFSET_Y)) != nullptr;
+            }
+        }
+        for (int y = SCREEN_OFFSET_Y; y < TOTAL_LINES; y++) {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                if (screenCharAt(newLines, x, y) == '#') {
+                    addSpringAt(room, newLines, x, y, springUsed);
+                }
+            }
+        }
+    }
+    
+    source.lines = newLines;
 }
 
 void Game::showMenu() {
@@ -194,8 +420,25 @@ void Game::showMenu() {
     gotoxy(30, 11);
     std::cout << "(1) Start New Game";
     gotoxy(30, 12);
-    std::cout << "(8) Instructions";
+    std::cout << "(2) Dark mode: " << (darkMode ? "ON " : "OFF");
     gotoxy(30, 13);
+    std::cout << "(3) Autopilot: ";
+    if (autopilotSetting == 0) {
+        std::cout << "OFF";
+    } else if (autopilotSetting > playerCount) {
+        std::cout << "ALL";
+    } else {
+        std::cout << "P" << autopilotSetting << " ";
+    }
+    gotoxy(30, 14);
+    std::cout << "(4) Continue saved game";
+    gotoxy(30, 15);
+    std::cout << "(5) Players: " << playerCount << " ";
+    gotoxy(30, 16);
+    std::cout << "(7) Controls";
+    gotoxy(30, 17);
+    std::cout << "(8) Instructions";
+    gotoxy(30, 18);
     std::cout << "(9) Exit";
     
     while (true) {
@@ -204,6 +447,26 @@ void Game::showMenu() {
             if (choice == '1') {
                 state = GameState::PLAYING;
                 return;
+            } else if (choice == '2') {
+                darkMode = !darkMode;
+                showMenu();
+                return;
+            } else if (choice == '3') {
+                autopilotSetting = (autopilotSetting + 1) % (playerCount + 2);
+                showMenu();
+                return;
+            } else if (choice == '4') {
+                continueFromSave = true;
+                state = GameState::PLAYING;
+                return;
+            } else if (choice == '5') {
+                setPlayerCount(playerCount % MAX_PLAYERS + 1);
+                showMenu();
+                return;
+            } else if (choice == '7') {
+                showControls();
+                showMenu();
+                return;
             } else if (choice == '8') {
                 showInstructions();
                 showMenu();
@@ -221,16 +484,23 @@ void Game::showInstructions() {
     clearScreen();
     gotoxy(10, 3);
     std::cout << "=== INSTRUCTIONS ===";
-    gotoxy(5, 5);
-    std::cout << "Player 1: W(up) A(left) S(stay) D(right) X(down) E(dispose)";
-    gotoxy(5, 6);
-    std::cout << "Player 2: I(up) J(left) K(stay) L(right) M(down) O(dispose)";
+    // First two players' keys (all players are listed under Controls)
+    for (int p = 0; p < 2 && p < playerCount; p++) {
+        gotoxy(5, 5 + p);
+        std::cout << "Player " << (p + 1) << ":";
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            char key = keyMap.getKey(p, (PlayerAction)a);
+            std::cout << " " << (key ? key : '-') << "(" << KeyMap::getActionName((PlayerAction)a) << ")";
+        }
+    }
     gotoxy(5, 8);
     std::cout << "ESC - Pause game";
+    gotoxy(5, 9);
+    std::cout << "R - Rewind 3 seconds (up to 30 seconds back)";
     gotoxy(5, 10);
     std::cout << "Collect keys (K) to open doors (1,2,3)";
     gotoxy(5, 11);
-    std::cout << "Torches (!) light the way";
+    std::cout << "Torches (!) light the way in dark mode";
     gotoxy(5, 12);
     std::cout << "Bombs (@) destroy walls when disposed";
     gotoxy(5, 13);
@@ -240,16 +510,55 @@ void Game::showInstructions() {
     gotoxy(5, 15);
     std::cout << "Switches (\\//) - Step on them to toggle, open doors when all ON";
     gotoxy(5, 16);
-    std::cout << "Springs (#) - Launch you in their direction when compressed";
-    gotoxy(5, 18);
+    std::cout << "Springs (#) - Compress them against their wall to get launched away";
+    gotoxy(5, 17);
+    std::cout << "Enemies (E) - Chase you, touching one costs a life";
+    gotoxy(5, 19);
     std::cout << "Press any key to continue...";
     _getch();
 }
 
+// Lets the user rebind any player's keys, changes are saved to KEYMAP_FILE
+void Game::showControls() {
+    int player = 0;
+    
+    while (true) {
+        clearScreen();
+        gotoxy(10, 3);
+        std::cout << "=== CONTROLS - Player " << (player + 1) << " (" << Chars::PLAYER_SYMBOLS[player] << ") ===";
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            char key = keyMap.getKey(player, (PlayerAction)a);
+            gotoxy(5, 4 + a);
+            std::cout << "(" << a << ") " << KeyMap::getActionName((PlayerAction)a);
+            gotoxy(20, 4 + a);
+            std::cout << (key ? key : '-');
+        }
+        gotoxy(5, 5 + PLAYER_ACTION_COUNT);
+        std::cout << "(N) Next player  (P) Previous player  (ESC) Back";
+        
+        char choice = toUpperCase(_getch());
+        if (choice == Keys::ESC) {
+            keyMap.saveToFile(KEYMAP_FILE);
+            return;
+        } else if (choice == 'N') {
+            player = (player + 1) % playerCount;
+        } else if (choice == 'P') {
+            player = (player + playerCount - 1) % playerCount;
+        } else if (choice >= '1' && choice < '0' + PLAYER_ACTION_COUNT) {
+            PlayerAction action = (PlayerAction)(choice - '0');
+            gotoxy(5, 7 + PLAYER_ACTION_COUNT);
+            std::cout << "Press new key for " << KeyMap::getActionName(action) << "...";
+            keyMap.bind(player, action, _getch());
+        }
+    }
+}
+
 void Game::pauseGame() {
     clearScreen();  // FIXED: Clear screen when pausing
     gotoxy(20, 10);
     std::cout << "PAUSED - ESC to continue, H for menu";
+    gotoxy(20, 11);
+    std::cout << "S to quick-save, L to quick-load";
     
     while (true) {
         if (_kbhit()) {
@@ -260,518 +569,939 @@ void Game::pauseGame() {
             } else if (key == Keys::HOME) {
                 state = GameState::MENU;
                 return;
+            } else if (key == Keys::QUICK_SAVE) {
+                saveGame();
+                gotoxy(20, 13);
+                std::cout << "Game saved.          ";
+            } else if (key == Keys::QUICK_LOAD) {
+                if (loadGame()) {
+                    clearScreen();
+                    return;
+                }
+                gotoxy(20, 13);
+                std::cout << "No usable save found.";
             }
         }
         Sleep(50);
     }
 }
 
-// UNIFIED: Handles input for a single player based on their keys
-void Game::handlePlayerInput(Player* player, char key) {
-    // Determine which player this is
-    bool isPlayer1 = (player == player1.get());
+// Table-driven: the key map tells us which player the key belongs to and what it does
+void Game::handlePlayerInput(char key) {
+    const KeyBinding& binding = keyMap.lookup(key);
+    if (binding.player >= players.size()) return;
     
-    // Check direction keys
-    if ((isPlayer1 && key == Keys::P1_UP) || (!isPlayer1 && key == Keys::P2_UP)) {
-        player->setDirection(Direction::UP);
-    } else if ((isPlayer1 && key == Keys::P1_DOWN) || (!isPlayer1 && key == Keys::P2_DOWN)) {
-        player->setDirection(Direction::DOWN);
-    } else if ((isPlayer1 && key == Keys::P1_LEFT) || (!isPlayer1 && key == Keys::P2_LEFT)) {
-        player->setDirection(Direction::LEFT);
-    } else if ((isPlayer1 && key == Keys::P1_RIGHT) || (!isPlayer1 && key == Keys::P2_RIGHT)) {
-        player->setDirection(Direction::RIGHT);
-    } else if ((isPlayer1 && key == Keys::P1_STAY) || (!isPlayer1 && key == Keys::P2_STAY)) {
-        player->stop();
-    } else if ((isPlayer1 && key == Keys::P1_DISPOSE) || (!isPlayer1 && key == Keys::P2_DISPOSE)) {
-        if (player->hasItem()) {
-            GameElement* item = player->disposeItem();
-            item->setPosition(player->getPosition());
-            
-            // Activate bomb if disposing a bomb
-            if (Bomb* bomb = dynamic_cast<Bomb*>(item)) {
-                bomb->activate();
+    if (latency) latency->tagInput(binding.player, binding.action);
+    applyAction(players[binding.player].get(), binding.action);
+}
+
+void Game::applyAction(Player* player, PlayerAction action) {
+    switch (action) {
+        case PlayerAction::UP:
+            player->setDirection(Direction::UP);
+            break;
+        case PlayerAction::DOWN:
+            player->setDirection(Direction::DOWN);
+            break;
+        case PlayerAction::LEFT:
+            player->setDirection(Direction::LEFT);
+            break;
+        case PlayerAction::RIGHT:
+            player->setDirection(Direction::RIGHT);
+            break;
+        case PlayerAction::STAY:
+            player->stop();
+            break;
+        case PlayerAction::DISPOSE:
+            // Items can only be dropped on an empty cell
+            if (player->hasItem() &&
+                getPlayerRoom(player)->placeElement(player->getHeldItem(), player->getPosition())) {
+                GameElement* item = player->disposeItem();
+                
+                // Activate bomb if disposing a bomb
+                if (Bomb* bomb = dynamic_cast<Bomb*>(item)) {
+                    bomb->activate();
+                }
             }
+            break;
+        default:
+            break;
+    }
+}
+
+// Bot players choose their action for this cycle, like a key press would
+void Game::updateAutopilots() {
+    for (int i = 0; i < (int)autopilots.size(); i++) {
+        Autopilot* bot = autopilots[i].get();
+        if (!bot) continue;
+        
+        Player* player = players[i].get();
+        if (bot->shouldDispose(player)) {
+            applyAction(player, PlayerAction::DISPOSE);  // Before moving, so it isn't picked up again
         }
+        applyAction(player, bot->think(getPlayerRoom(player), player));
+    }
+}
+
+// Players in different rooms can't meet, so each room is resolved on its own
+void Game::updatePlayers() {
+    for (int i = 0; i < (int)rooms.size(); i++) {
+        movePlayersInRoom(i);
     }
 }
 
-// UNIFIED: Updates a single player's position
-void Game::updatePlayer(Player* player, Player* otherPlayer) {
-    Room* room = getCurrentRoom();
-    Direction moveDir = player->getDirection();
+// Moves the room's players in one batch per step. Normal walking is one step, a spring
+// launch is `velocity` steps plus an optional sideways step. Every step round is
+// resolved for all players together by the MoveResolver.
+void Game::movePlayersInRoom(int roomIndex) {
+    Room* room = rooms[roomIndex].get();
+    
+    moveBatch.clear();
+    stepPlans.clear();
+    int rounds = 0;
     
-    // If under spring effect, use spring direction and velocity
-    if (player->isUnderSpringEffect()) {
-        Direction springDir = player->getSpringDirection();
-        int velocity = player->getSpringVelocity();
+    for (const auto& player : players) {
+        if (player->getRoomIndex() != roomIndex) continue;
         
-        // Check if player is trying to move backward against spring
-        Point backwardCheck = directionToPoint(springDir);
-        backwardCheck = Point(-backwardCheck.getX(), -backwardCheck.getY());
-        Point tryMove = directionToPoint(moveDir);
+        StepPlan plan;
+        plan.springSteps = 0;
+        plan.walkDir = player->getDirection();
+        plan.halted = false;
         
-        // Ignore backward or stay commands
-        if (moveDir == Direction::NONE || 
-            (tryMove.getX() == backwardCheck.getX() && tryMove.getY() == backwardCheck.getY())) {
-            // Just use spring direction
-            moveDir = springDir;
-        } else {
-            // Allow lateral movement (perpendicular to spring)
-            // Spring moves in springDir, player can add lateral component
-            // For now, simplified: move in spring direction with lateral offset
-            Point springMove = directionToPoint(springDir);
-            Point lateralMove = directionToPoint(moveDir);
+        // If under spring effect, use spring direction and velocity
+        if (player->isUnderSpringEffect()) {
+            Direction springDir = player->getSpringDirection();
+            Point backward = directionToPoint(springDir);
+            backward = Point(-backward.getX(), -backward.getY());
             
-            // Move multiple times based on velocity
-            for (int v = 0; v < velocity; v++) {
-                Point nextPos = player->getPosition() + springMove;
-                
-                // Check if other player is there
-                if (nextPos == otherPlayer->getPosition()) {
-                    // Transfer spring effect to other player
-                    otherPlayer->setSpringEffect(springDir, velocity, velocity * velocity);
-                    otherPlayer->stop();
-                    player->stop();
-                    return;
-                }
-                
-                // Check walkability
-                if (room->isPositionWalkable(nextPos) && room->getElementAt(nextPos) == nullptr) {
-                    player->setPosition(nextPos);
-                } else {
-                    // Hit obstacle, stop
-                    player->stop();
-                    player->clearSpringEffect();
-                    return;
-                }
-            }
+            plan.springSteps = player->getSpringVelocity();
             
-            // Apply lateral movement (once)
-            if (moveDir != springDir && moveDir != Direction::NONE) {
-                Point nextLateral = player->getPosition() + lateralMove;
-                if (room->isPositionWalkable(nextLateral) && 
-                    room->getElementAt(nextLateral) == nullptr &&
-                    nextLateral != otherPlayer->getPosition()) {
-                    player->setPosition(nextLateral);
-                }
+            // Backward, stay and same-direction commands add nothing to the launch,
+            // anything else becomes one lateral step after the spring steps
+            if (plan.walkDir == springDir || directionToPoint(plan.walkDir) == backward) {
+                plan.walkDir = Direction::NONE;
             }
-            
-            return;
         }
         
-        // Move according to spring velocity
-        for (int v = 0; v < velocity; v++) {
-            Point nextPos = player->getPosition() + directionToPoint(springDir);
-            
-            // Check if other player is there
-            if (nextPos == otherPlayer->getPosition()) {
-                // Transfer spring effect to other player
-                otherPlayer->setSpringEffect(springDir, velocity, velocity * velocity);
-                otherPlayer->stop();
-                player->stop();
-                return;
-            }
+        int steps = plan.springSteps + (plan.walkDir != Direction::NONE ? 1 : 0);
+        rounds = std::max(rounds, steps);
+        
+        moveBatch.push_back(player.get());
+        stepPlans.push_back(plan);
+    }
+    if (moveBatch.empty()) return;
+    
+    for (int round = 0; round < rounds; round++) {
+        moveResolver.begin((int)moveBatch.size());
+        
+        for (int i = 0; i < (int)moveBatch.size(); i++) {
+            const StepPlan& plan = stepPlans[i];
+            if (plan.halted) continue;
             
-            // Check walkability
-            if (room->isPositionWalkable(nextPos) && room->getElementAt(nextPos) == nullptr) {
-                player->setPosition(nextPos);
-            } else {
-                // Hit obstacle, stop
-                player->stop();
-                player->clearSpringEffect();
-                return;
+            if (round < plan.springSteps) {
+                moveResolver.addIntent(i, moveBatch[i]->getSpringDirection(), MoveResolver::StepKind::SPRING);
+            } else if (round == plan.springSteps) {
+                MoveResolver::StepKind kind = plan.springSteps > 0 ? MoveResolver::StepKind::LATERAL
+                                                                   : MoveResolver::StepKind::WALK;
+                moveResolver.addIntent(i, plan.walkDir, kind);
             }
         }
         
-        return;
-    }
-    
-    // Normal movement (no spring effect)
-    if (moveDir == Direction::NONE) return;
-    
-    Point nextPos = player->getNextPosition();
-    
-    // Check if position has obstacle
-    Obstacle* obs = room->getObstacleAt(nextPos);
-    if (obs) {
-        // Try to push it
-        if (room->tryPushObstacle(obs, player->getDirection())) {
-            // Obstacle moved, player can move
-            player->setPosition(nextPos);
-        } else {
-            // Can't push, stop player
-            player->stop();
+        moveResolver.resolve(room, moveBatch);
+        
+        // A stopped launch also cancels the sideways step
+        for (int i = 0; i < (int)moveBatch.size(); i++) {
+            if (round < stepPlans[i].springSteps && moveResolver.isBlocked(i)) {
+                stepPlans[i].halted = true;
+            }
         }
-        return;
-    }
-    
-    // Check if other player is there
-    if (nextPos == otherPlayer->getPosition()) {
-        player->stop();
-        return;
-    }
-    
-    // Check if walkable
-    if (room->isPositionWalkable(nextPos)) {
-        player->setPosition(nextPos);
-    } else {
-        player->stop();
     }
 }
 
 void Game::checkCollisions() {
-    Room* room = getCurrentRoom();
-    
-    // Check player 1
-    GameElement* elem1 = room->getElementAt(player1->getPosition());
-    if (elem1 && elem1->isCollectible() && !player1->hasItem()) {
-        player1->pickUpItem(elem1);
-        room->markElementAsCollected(elem1);
-    }
-    
-    // Check player 2
-    GameElement* elem2 = room->getElementAt(player2->getPosition());
-    if (elem2 && elem2->isCollectible() && !player2->hasItem()) {
-        player2->pickUpItem(elem2);
-        room->markElementAsCollected(elem2);
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        Room* room = getPlayerRoom(player);
+        GameElement* elem = room->getElementAt(player->getPosition());
+        if (elem && elem->isCollectible() && !player->hasItem()) {
+            recordEvent(TelemetryType::PICKUP, i, player->getRoomIndex(), elem->getPosition(), elem->getDisplayChar());
+            postScriptEvent(ScriptEvent::PICKUP, i, player->getRoomIndex(), elem->getPosition(), elem->getDisplayChar());
+            // Numbered once here for saves and rewinds. An item carried over
+            // from another room is numbered by that room.
+            int itemRoom = player->getRoomIndex();
+            int itemIndex = room->getElementIndex(elem);
+            for (int r = 0; r < (int)rooms.size() && itemIndex < 0; r++) {
+                itemRoom = r;
+                itemIndex = rooms[r]->getElementIndex(elem);
+            }
+            player->pickUpItem(elem, itemRoom, itemIndex);
+            room->markElementAsCollected(elem);
+        }
     }
 }
 
 void Game::checkDoors() {
-    Room* room = getCurrentRoom();
-    
-    // Check player 1
-    Door* door1 = room->getDoorAt(player1->getPosition());
-    if (door1 && player1->hasItem() && !player1ReachedEnd) {  // Don't check if already finished
-        if (dynamic_cast<Key*>(player1->getHeldItem())) {
-            // Check if switches are activated for this door
-            if (!room->areSwitchesActivated(door1->getSwitchGroupId())) {
-                return;  // Door is locked by switches
-            }
-            
-            player1->disposeItem();  // Use key
-            
-            // Check if we're in the final room before advancing
-            if (getCurrentRoom()->getIsFinalRoom()) {
-                player1ReachedEnd = true;
-                player1->stop();
-                return;  // Player finished the game
-            }
-            
-            currentRoomIndex++;
-            score += 100;  // Add 100 points for moving to new room
-            if (currentRoomIndex >= (int)rooms.size()) {
-                currentRoomIndex = rooms.size() - 1;
-            }
-            player1->setPosition(Point(5, 10));
-            player1->stop();
-            return;  // Room changed, stop checking
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        Room* room = getPlayerRoom(player);
+        Door* door = room->getDoorAt(player->getPosition());
+        if (!door || !player->hasItem() || player->hasReachedEnd()) {  // Don't check if already finished
+            continue;
         }
-    }
-    
-    // Check player 2
-    Door* door2 = room->getDoorAt(player2->getPosition());
-    if (door2 && player2->hasItem() && !player2ReachedEnd) {  // Don't check if already finished
-        if (dynamic_cast<Key*>(player2->getHeldItem())) {
-            // Check if switches are activated for this door
-            if (!room->areSwitchesActivated(door2->getSwitchGroupId())) {
-                return;  // Door is locked by switches
-            }
-            
-            player2->disposeItem();  // Use key
-            
-            // Check if we're in the final room before advancing
-            if (getCurrentRoom()->getIsFinalRoom()) {
-                player2ReachedEnd = true;
-                player2->stop();
-                return;  // Player finished the game
-            }
-            
-            currentRoomIndex++;
-            score += 100;  // Add 100 points for moving to new room
-            if (currentRoomIndex >= (int)rooms.size()) {
-                currentRoomIndex = rooms.size() - 1;
-            }
-            player2->setPosition(Point(5, 12));
-            player2->stop();
+        if (!dynamic_cast<Key*>(player->getHeldItem())) {
+            continue;
+        }
+        
+        // Check if switches are activated for this door
+        if (!room->areSwitchesActivated(door->getSwitchGroupId())) {
+            continue;  // Door is locked by switches
         }
+        
+        player->disposeItem();  // Use key
+        postScriptEvent(ScriptEvent::DOOR, i, player->getRoomIndex(), door->getPosition(), door->getDoorNumber());
+        
+        // Check if we're in the final room before advancing
+        if (room->getIsFinalRoom()) {
+            recordEvent(TelemetryType::DOOR, i, player->getRoomIndex(), door->getPosition(), ' ', -1);
+            player->setReachedEnd(true);
+            player->stop();
+            continue;  // Player finished the game
+        }
+        
+        // Only this player moves on, the others stay where they are
+        int nextRoom = std::min(player->getRoomIndex() + 1, (int)rooms.size() - 1);
+        if (nextRoom > furthestRoomIndex) {
+            furthestRoomIndex = nextRoom;
+            score += 100;  // Add 100 points for reaching a new room
+        }
+        recordEvent(TelemetryType::DOOR, i, player->getRoomIndex(), door->getPosition(), ' ', nextRoom);
+        AllocTracker::restartWarmup();  // The new room's chunks and views load now
+        player->setRoomIndex(nextRoom);
+        player->setPosition(getSpawnPoint(i));
+        player->stop();
     }
 }
 
 void Game::checkSwitches() {
-    Room* room = getCurrentRoom();
-    
-    // Check player 1 position (only toggle when stepping onto a switch)
+    // Only toggle when stepping onto a switch
     // We check if player moved this frame by checking direction
-    if (player1->getDirection() != Direction::NONE) {
-        Switch* sw1 = room->getSwitchAt(player1->getPosition());
-        if (sw1) {
-            sw1->toggle();
-        }
-    }
-    
-    // Check player 2
-    if (player2->getDirection() != Direction::NONE) {
-        Switch* sw2 = room->getSwitchAt(player2->getPosition());
-        if (sw2) {
-            sw2->toggle();
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        if (player->getDirection() != Direction::NONE) {
+            Switch* sw = getPlayerRoom(player)->getSwitchAt(player->getPosition());
+            if (sw) {
+                sw->toggle();
+                postScriptEvent(ScriptEvent::SWITCH, i, player->getRoomIndex(), sw->getPosition(), sw->getGroupId());
+            }
         }
     }
 }
 
+// Walking towards a spring's wall compresses it, one char per cell walked.
+// Reaching the wall (or pressing stay) launches the player away from the wall
+// with speed = compressed chars, for speed^2 cycles.
 void Game::checkSprings() {
-    Room* room = getCurrentRoom();
-    
-    // Check player 1
-    Spring* spring1 = room->getSpringAt(player1->getPosition());
-    if (spring1 && !player1->isUnderSpringEffect()) {
-        // Player stepped onto a spring
-        Direction springDir = spring1->getAlignment();
-        Direction playerDir = player1->getDirection();
-        
-        // Check if player is moving in the spring direction
-        if (playerDir == springDir) {
-            // Start compressing the spring
-            // Calculate how many spring chars the player will compress
-            Point springMove = directionToPoint(springDir);
-            int compressed = 0;
-            Point checkPos = player1->getPosition();
-            
-            // Count consecutive spring positions ahead
-            for (int i = 0; i < spring1->getLength(); i++) {
-                checkPos = checkPos + springMove;
-                if (spring1->isPartOfSpring(checkPos)) {
-                    compressed++;
-                } else {
-                    break;
-                }
-                
-                // Stop if hit a wall
-                if (room->isWall(checkPos)) {
-                    break;
-                }
-            }
+    for (const auto& player : players) {
+        if (player->isUnderSpringEffect()) {
+            continue;
+        }
+        
+        SpringCell cell = getPlayerRoom(player.get())->getSpringCellAt(player->getPosition());
+        if (!cell.spring) {
+            continue;
+        }
+        
+        Spring* spring = cell.spring;
+        Direction launchDir = spring->getAlignment();
+        Point launch = directionToPoint(launchDir);
+        Point towardsWall(-launch.getX(), -launch.getY());
+        Direction playerDir = player->getDirection();
+        
+        int compressed = 0;
+        if (directionToPoint(playerDir) == towardsWall) {
+            // Everything from the player's cell to the free end is compressed
+            compressed = spring->getLength() - cell.offset;
+            spring->compress(compressed);
             
-            // Compress the spring visually
-            if (compressed > 0) {
-                spring1->compress(compressed);
+            if (cell.offset > 0) {
+                continue;  // Keep compressing
             }
-            
-            // Check if next position after spring compression is a wall or stay command
-            Point nextAfterSpring = player1->getPosition() + Point(springMove.getX() * (compressed + 1), 
-                                                                     springMove.getY() * (compressed + 1));
-            bool hitWall = room->isWall(nextAfterSpring);
-            
-            if (compressed > 0 && (hitWall || playerDir == Direction::NONE)) {
-                // Launch the player
-                int velocity = compressed;
-                int cycles = compressed * compressed;
-                player1->setSpringEffect(springDir, velocity, cycles);
-                spring1->release();
+        } else if (playerDir == Direction::NONE && spring->getIsCompressed()) {
+            compressed = spring->getCompressedLength();
+        } else {
+            spring->release();  // Walked off without launching
+            continue;
+        }
+        
+        // Launch the player
+        int velocity = compressed;
+        int cycles = compressed * compressed;
+        player->setSpringEffect(launchDir, velocity, cycles);
+        spring->release();
+    }
+}
+
+void Game::updateSpringEffects() {
+    // Decrement spring cycles for every player
+    for (const auto& player : players) {
+        if (player->isUnderSpringEffect()) {
+            player->decrementSpringCycles();
+            if (!player->isUnderSpringEffect()) {
+                player->clearSpringEffect();
             }
         }
     }
+}
+
+// Recomputes each player's field of view (only when it changed) and merges them
+void Game::updateLighting() {
+    playerViews.resize(players.size());
+    while (litCells.size() < rooms.size()) {
+        const Room* room = rooms[litCells.size()].get();
+        litCells.emplace_back(room->getWidth(), room->getHeight());
+        rememberedCells.emplace_back(room->getWidth(), room->getHeight());
+    }
     
-    // Check player 2
-    Spring* spring2 = room->getSpringAt(player2->getPosition());
-    if (spring2 && !player2->isUnderSpringEffect()) {
-        // Player stepped onto a spring
-        Direction springDir = spring2->getAlignment();
-        Direction playerDir = player2->getDirection();
+    for (int r = 0; r < (int)rooms.size(); r++) {
+        litCells[r].clear();
+    }
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        int r = player->getRoomIndex();
+        int radius = dynamic_cast<Torch*>(player->getHeldItem()) ? TORCH_RADIUS : DARK_RADIUS;
         
-        // Check if player is moving in the spring direction
-        if (playerDir == springDir) {
-            // Start compressing the spring
-            // Calculate how many spring chars the player will compress
-            Point springMove = directionToPoint(springDir);
-            int compressed = 0;
-            Point checkPos = player2->getPosition();
-            
-            // Count consecutive spring positions ahead
-            for (int i = 0; i < spring2->getLength(); i++) {
-                checkPos = checkPos + springMove;
-                if (spring2->isPartOfSpring(checkPos)) {
-                    compressed++;
-                } else {
-                    break;
-                }
-                
-                // Stop if hit a wall
-                if (room->isWall(checkPos)) {
-                    break;
-                }
-            }
-            
-            // Compress the spring visually
-            if (compressed > 0) {
-                spring2->compress(compressed);
-            }
-            
-            // Check if next position after spring compression is a wall or stay command
-            Point nextAfterSpring = player2->getPosition() + Point(springMove.getX() * (compressed + 1), 
-                                                                     springMove.getY() * (compressed + 1));
-            bool hitWall = room->isWall(nextAfterSpring);
-            
-            if (compressed > 0 && (hitWall || playerDir == Direction::NONE)) {
-                // Launch the player
-                int velocity = compressed;
-                int cycles = compressed * compressed;
-                player2->setSpringEffect(springDir, velocity, cycles);
-                spring2->release();
-            }
+        // Memory only grows, a view that didn't change adds nothing new to it
+        if (playerViews[i].update(rooms[r].get(), player->getPosition(), radius)) {
+            rememberedCells[r].orWith(playerViews[i].getVisible());
         }
+        litCells[r].orWith(playerViews[i].getVisible());
     }
 }
 
-void Game::updateSpringEffects() {
-    // Decrement spring cycles for both players
-    if (player1->isUnderSpringEffect()) {
-        player1->decrementSpringCycles();
-        if (!player1->isUnderSpringEffect()) {
-            player1->clearSpringEffect();
+// Steps every loaded room, not just the current one, so bombs keep ticking and
+// enemies keep moving after the players left. Rooms don't share any state, so
+// each one is a separate task; runAll returns once all of them are done.
+void Game::updateRooms() {
+    roomPlayerPositions.resize(rooms.size());
+    for (std::vector<Point>& positions : roomPlayerPositions) {
+        positions.clear();
+    }
+    heldItems.clear();
+    for (const auto& player : players) {
+        roomPlayerPositions[player->getRoomIndex()].push_back(player->getPosition());
+        if (player->hasItem()) {
+            heldItems.push_back(player->getHeldItem());
         }
     }
     
-    if (player2->isUnderSpringEffect()) {
-        player2->decrementSpringCycles();
-        if (!player2->isUnderSpringEffect()) {
-            player2->clearSpringEffect();
+    roomWorkers.runAll((int)rooms.size(), [this](int i) {
+        rooms[i]->update(roomPlayerPositions[i], heldItems);
+    });
+}
+
+// Touching an enemy costs a life
+void Game::checkEnemies() {
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        Room* room = getPlayerRoom(player);
+        Enemy* enemy = dynamic_cast<Enemy*>(room->getElementAt(player->getPosition()));
+        if (enemy) {
+            lives--;
+            recordEvent(TelemetryType::LIFE_LOST, i, player->getRoomIndex(), player->getPosition(), 'E', lives);
+            room->respawnEnemy(enemy);
         }
     }
 }
 
+void Game::recordEvent(TelemetryType type, int playerIndex, int roomIndex, Point pos, char detail, int value) {
+    if (!telemetry) return;
+    
+    TelemetryEvent event;
+    event.tick = telemetryTick;
+    event.type = (uint8_t)type;
+    event.player = playerIndex < 0 ? TELEMETRY_NO_PLAYER : (uint8_t)playerIndex;
+    event.room = (uint8_t)roomIndex;
+    event.detail = detail;
+    event.x = (int16_t)pos.getX();
+    event.y = (int16_t)pos.getY();
+    event.value = value;
+    telemetry->record(event);
+}
+
+// Bombs go off on the room workers, the rooms keep a list for the game thread
+void Game::recordDetonations() {
+    for (int i = 0; i < (int)rooms.size(); i++) {
+        detonations.clear();
+        rooms[i]->takeDetonations(detonations);
+        for (Point pos : detonations) {
+            recordEvent(TelemetryType::BOMB_DETONATED, -1, i, pos);
+            postScriptEvent(ScriptEvent::BOMB, -1, i, pos);
+        }
+    }
+}
+
+int Game::getPlayerIndex(const Player* player) const {
+    for (int i = 0; i < (int)players.size(); i++) {
+        if (players[i].get() == player) return i;
+    }
+    return -1;
+}
+
+void Game::postScriptEvent(ScriptEvent event, int playerIndex, int roomIndex, Point pos, int value) {
+    scripts.post(roomIndex, event, playerIndex, pos, value);
+}
+
+// One ENTER per cell a player moved to this cycle (spring launches only report where they end)
+void Game::postEnterEvents() {
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        if (player->getRoomIndex() == scriptRooms[i] && player->getPosition() == scriptCells[i]) continue;
+        scriptRooms[i] = player->getRoomIndex();
+        scriptCells[i] = player->getPosition();
+        postScriptEvent(ScriptEvent::ENTER, i, scriptRooms[i], scriptCells[i]);
+    }
+}
+
+int Game::getScriptValue(ScriptValue value) {
+    switch (value) {
+        case ScriptValue::TICK: return (int)telemetryTick;
+        case ScriptValue::SCORE: return score;
+        case ScriptValue::LIVES: return lives;
+    }
+    return 0;
+}
+
+void Game::runScriptEffect(ScriptOp op, int room, int player, int a, int b, const std::string& text) {
+    switch (op) {
+        case ScriptOp::SCORE:
+            score += a;
+            break;
+        case ScriptOp::LIVES:
+            lives += a;
+            break;
+        case ScriptOp::OPEN:
+            rooms[room]->runTriggerAction(TriggerAction{ TriggerAction::Type::OPEN_WALL, Point(a, b) });
+            break;
+        case ScriptOp::ARM:
+            rooms[room]->runTriggerAction(TriggerAction{ TriggerAction::Type::ARM_BOMB, Point(a, b) });
+            break;
+        case ScriptOp::SAY:
+            scriptMessage = text;
+            scriptMessageTicks = SCRIPT_MESSAGE_TICKS;
+            break;
+        case ScriptOp::ASK:
+            if (!activeRiddle) break;  // Only while a riddle is open
+            riddleQuestion = text;
+            riddleAnswer = toUpperCase((char)a);
+            riddleAsked = true;
+            break;
+        case ScriptOp::GOTO:
+            // Players that already finished stay where they are
+            if (player < 0 || player >= (int)players.size() || a < 1 || a > (int)rooms.size()) break;
+            if (players[player]->hasReachedEnd()) break;
+            AllocTracker::restartWarmup();
+            players[player]->setRoomIndex(a - 1);
+            players[player]->setPosition(getSpawnPoint(player));
+            players[player]->stop();
+            getPlayerRoom(players[player].get())->loadChunksAround(players[player]->getPosition(), CHUNK_SIZE, CHUNK_SIZE);
+            break;
+        default:
+            break;
+    }
+}
+
 void Game::checkRiddles() {
-    Room* room = getCurrentRoom();
-    
-    // Check player 1
-    Riddle* riddle1 = room->getRiddleAt(player1->getPosition());
-    if (riddle1 && !riddle1->isActive()) {
-        riddle1->setActive(true);
-        activeRiddle = riddle1;
-        riddlePlayer = player1.get();
-        player1->stop();  // Stop player movement
-        return;
+    for (int i = 0; i < (int)players.size(); i++) {
+        Player* player = players[i].get();
+        Riddle* riddle = getPlayerRoom(player)->getRiddleAt(player->getPosition());
+        if (riddle && !riddle->isActive()) {
+            riddle->setActive(true);
+            activeRiddle = riddle;
+            riddlePlayer = player;
+            riddleQuestion = "Hello World";
+            riddleAnswer = Keys::SOLVE_RIDDLE;
+            riddleAsked = false;
+            player->stop();  // Stop player movement
+            // The room's script may still replace the question this cycle
+            postScriptEvent(ScriptEvent::RIDDLE, i, player->getRoomIndex(), riddle->getPosition());
+            return;
+        }
     }
+}
+
+void Game::drawRiddleOverlay(FrameBuffer& target) {
+    target.clear();
+    target.print(30, 10, riddleQuestion);
+    target.print(30, 12, riddleAsked ? "Answer with one key" : "Press 4 to solve the riddle");
+}
+
+// Viewports tile the play area: one room uses all of it, two rooms go side by side
+// (or stacked), more rooms go into a 2-column grid. Smaller viewports downsample.
+Viewport Game::getViewport(int view, int viewCount) const {
+    int columns = (viewCount == 1 || (viewCount == 2 && SPLIT_SCREEN_STACKED)) ? 1 : 2;
+    int rows = (viewCount + columns - 1) / columns;
+    
+    Viewport viewport;
+    viewport.width = SCREEN_WIDTH / columns;
+    viewport.height = SCREEN_HEIGHT / rows;
+    viewport.x = (view % columns) * viewport.width;
+    viewport.y = SCREEN_OFFSET_Y + (view / columns) * viewport.height;
+    viewport.cameraX = 0;
+    viewport.cameraY = 0;
+    return viewport;
+}
+
+// Composes the whole frame in memory and writes it out in one pass
+void Game::drawGame() {
+    AllocPhaseScope phase(AllocPhase::DRAW);
+    composeFrame(frame);
+    if (showLatency) drawLatencyOverlay();
+    latency->markSubmitted(presenter->submit(frame));
+    if (spectatorFrame) spectatorFrame->publish(frame);
+    if (recorder) recorder->capture(frame);
     
-    // Check player 2
-    Riddle* riddle2 = room->getRiddleAt(player2->getPosition());
-    if (riddle2 && !riddle2->isActive()) {
-        riddle2->setActive(true);
-        activeRiddle = riddle2;
-        riddlePlayer = player2.get();
-        player2->stop();  // Stop player movement
+    // Inputs whose effect reached the console since the last cycle
+    uint32_t shownFrame, shownAt;
+    presenter->getLastPresented(shownFrame, shownAt);
+    latency->markPresented(shownFrame, shownAt);
+}
+
+// Bottom right of the play area: one line per player, all actions together
+void Game::drawLatencyOverlay() {
+    int x = SCREEN_WIDTH - 36;
+    int y = SCREEN_OFFSET_Y + SCREEN_HEIGHT - playerCount - 1;
+    frame.print(x, y, "key->screen ms    n  p50  p95  max");
+    for (int p = 0; p < playerCount; p++) {
+        LatencyHistogram total = latency->getPlayerTotal(p);
+        char line[40];
+        snprintf(line, sizeof(line), "  player %c   %5u %4d %4d %4u", players[p]->getSymbol(), total.count,
+                 total.getPercentileMillis(50), total.getPercentileMillis(95), total.maxMicros / 1000);
+        frame.print(x, y + 1 + p, line);
     }
 }
 
-void Game::drawRiddleOverlay() {
-    clearScreen();
-    gotoxy(30, 10);
-    std::cout << "Hello World";
-    gotoxy(30, 12);
-    std::cout << "Press 4 to solve the riddle";
+// Moves whatever keys the console has into inputQueue, stamped with their arrival
+void Game::queueKeys() {
+    while (_kbhit()) {
+        TimedKey timed;
+        timed.key = toUpperCase(_getch());
+        timed.arrived = getMicroseconds();
+        inputQueue.push_back(timed);
+    }
 }
 
-void Game::drawGame() {
+bool Game::takeKey(char& key) {
+    if (inputQueue.empty()) return false;
+    key = inputQueue.front().key;
+    latency->keyArrived(inputQueue.front().arrived);
+    inputQueue.erase(inputQueue.begin());
+    return true;
+}
+
+void Game::waitForNextCycle() {
+    DWORD start = GetTickCount();
+    while (true) {
+        queueKeys();
+        int left = GAME_CYCLE_DELAY - (int)(GetTickCount() - start);
+        if (left <= 0) return;
+        Sleep(std::min(left, INPUT_POLL_MILLIS));
+    }
+}
+
+void Game::composeFrame(FrameBuffer& target) {
     if (activeRiddle) {
-        drawRiddleOverlay();
+        drawRiddleOverlay(target);
         return;
     }
     
-    clearScreen();
-    getCurrentRoom()->draw();
-    player1->draw();
-    player2->draw();
+    shownRooms.clear();
+    for (const auto& player : players) {
+        int r = player->getRoomIndex();
+        if (std::find(shownRooms.begin(), shownRooms.end(), r) == shownRooms.end()) {
+            shownRooms.push_back(r);
+        }
+    }
     
-    // Get legend position for current room
-    Point legendPos = legendPositions[currentRoomIndex];
-    getCurrentRoom()->drawLegend(player1.get(), player2.get(), legendPos.getX(), legendPos.getY(), lives, score);
+    target.clear();
+    for (int v = 0; v < (int)shownRooms.size(); v++) {
+        int r = shownRooms[v];
+        Viewport view = getViewport(v, (int)shownRooms.size());
+        view.cameraX = rooms[r]->getCamera().getOrigin().getX();
+        view.cameraY = rooms[r]->getCamera().getOrigin().getY();
+        
+        if (darkMode && r < (int)litCells.size()) {
+            rooms[r]->render(target, view, &litCells[r], &rememberedCells[r]);
+        } else {
+            rooms[r]->render(target, view);
+        }
+        for (const auto& player : players) {
+            Point pos = player->getPosition();
+            if (player->getRoomIndex() == r && view.shows(pos.getX(), pos.getY())) {
+                target.plot(view.mapX(pos.getX()), view.mapY(pos.getY()), player->getSymbol(), DRAW_PRIORITY_PLAYER);
+            }
+        }
+    }
+    
+    // Legend position of the first player's room
+    Point legendPos = legendPositions[shownRooms[0]];
+    rooms[shownRooms[0]]->drawLegend(target, players, legendPos.getX(), legendPos.getY(), lives, score);
+    
+    if (scriptMessageTicks > 0) {
+        int x = std::max(0, (SCREEN_WIDTH - (int)scriptMessage.size()) / 2);
+        target.print(x, SCREEN_OFFSET_Y + SCREEN_HEIGHT - 1, scriptMessage);
+    }
 }
 
-void Game::startNewGame() {
+// Fresh players and rooms, as at the start of a game
+void Game::resetGame() {
     // Reset state
-    currentRoomIndex = 0;
-    player1ReachedEnd = false;
-    player2ReachedEnd = false;
+    AllocTracker::restartWarmup();
+    furthestRoomIndex = 0;
     activeRiddle = nullptr;
     riddlePlayer = nullptr;
     lives = 3;
     score = 0;
+    telemetryTick = 0;
+    scriptMessageTicks = 0;
     
     // Reset players
-    player1 = std::make_unique<Player>(Point(5, 10), Chars::PLAYER1);
-    player2 = std::make_unique<Player>(Point(5, 12), Chars::PLAYER2);
+    createPlayers();
+    createAutopilots();
+    playerViews.clear();
+    litCells.clear();
+    rememberedCells.clear();
     
     // Reload rooms from files
     rooms.clear();
     legendPositions.clear();
-    loadRoomsFromFiles();
+    screenSources.clear();
+    loadRooms();
+    rewindBuffer.clear();
+    
+    // Large rooms only hold the chunks somebody is near
+    for (const auto& player : players) {
+        getPlayerRoom(player.get())->loadChunksAround(player->getPosition(), CHUNK_SIZE, CHUNK_SIZE);
+    }
+    
+    // Spawn cells don't count as entered
+    scriptRooms.clear();
+    scriptCells.clear();
+    for (const auto& player : players) {
+        scriptRooms.push_back(player->getRoomIndex());
+        scriptCells.push_back(player->getPosition());
+    }
+    for (int r = 0; r < (int)rooms.size(); r++) {
+        postScriptEvent(ScriptEvent::START, -1, r, Point(0, 0));
+    }
+}
+
+// Builds the blob in memory (fast) and hands the disk write to a background thread
+void Game::saveGame() {
+    StateVector state;
+    StateWriter out(state);
+    writeState(out, true);
+    
+    std::vector<char> bytes;
+    encodeSave(state, bytes);
+    
+    if (saveThread.joinable()) {
+        saveThread.join();  // Previous save is long done by now
+    }
+    saveThread = std::thread([bytes = std::move(bytes)]() {
+        AllocTracker::setSubsystem(AllocSubsystem::SAVE);
+        std::ofstream file(SAVE_FILE, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    });
+}
+
+// Lays the saved state over the rooms as they are, like a rewind: elements
+// move back and large rooms load and drop chunks to match, nothing is rebuilt.
+// A save that doesn't fit puts the game back the way it was.
+bool Game::loadGame() {
+    if (saveThread.joinable()) {
+        saveThread.join();  // The file may still be being written
+    }
+    
+    StateVector saved;
+    {
+        MappedFile file(SAVE_FILE);
+        if (!file.isOpen() || !decodeSave(file.getData(), file.getSize(), saved)) {
+            return false;
+        }
+    }
+    
+    StateVector backup;
+    StateWriter out(backup);
+    writeState(out, true);
+    
+    StateReader in(saved);
+    if (!readState(in)) {
+        StateReader previous(backup);
+        readState(previous);
+        return false;
+    }
+    
+    // Nothing from before the load carries over: an open riddle, the rewind
+    // history, a script message, what the players saw
+    if (activeRiddle) {
+        activeRiddle->setActive(false);
+        activeRiddle = nullptr;
+        riddlePlayer = nullptr;
+    }
+    rewindBuffer.clear();
+    scriptMessageTicks = 0;
+    playerViews.clear();
+    litCells.clear();
+    rememberedCells.clear();
+    createAutopilots();
+    return true;
+}
+
+void Game::recordRewindFrame() {
+    if (headless) return;
+    
+    rewindState.clear();
+    StateWriter out(rewindState);
+    writeState(out);
+    
+    // A full script queue fits on top, handlers coming and going don't reallocate
+    size_t stateRoom = rewindState.size() + ScriptVM::getQueueStateLimit();
+    if (rewindState.capacity() < stateRoom) {
+        rewindBuffer.reserve(stateRoom);
+        rewindState.reserve(stateRoom);
+    }
+    rewindBuffer.record(rewindState);
+}
+
+// Back to the start of an earlier cycle, an open riddle is dropped
+void Game::rewindGame(int ticks) {
+    if (activeRiddle) {
+        activeRiddle->setActive(false);
+        activeRiddle = nullptr;
+        riddlePlayer = nullptr;
+    }
+    if (!rewindBuffer.rewind(ticks, rewindState)) return;
+    
+    StateReader in(rewindState);
+    readState(in);
+}
+
+void Game::writeState(StateWriter& out, bool complete) const {
+    out.writeInt(playerCount);
+    out.writeInt((int)rooms.size());
+    out.writeInt(lives);
+    out.writeInt(score);
+    out.writeInt(furthestRoomIndex);
+    
+    for (const auto& room : rooms) {
+        room->writeState(out, complete);
+    }
+    
+    for (const auto& player : players) {
+        out.writePoint(player->getPosition());
+        out.writeInt((int)player->getDirection());
+        out.writeInt(player->getRoomIndex());
+        out.writeBool(player->hasReachedEnd());
+        out.writeInt((int)player->getSpringDirection());
+        out.writeInt(player->getSpringVelocity());
+        out.writeInt(player->getSpringCyclesRemaining());
+        
+        // Held item as (room, element number), noted when it was picked up
+        out.writeInt(player->getHeldItemRoom());
+        out.writeInt(player->getHeldItemIndex());
+    }
+    
+    // Last, a handler queue that changes length doesn't move the values above
+    scripts.writeState(out);
+}
+
+bool Game::readState(StateReader& in) {
+    AllocTracker::restartWarmup();  // Loads and rewinds
+    if (in.readInt() != playerCount || in.readInt() != (int)rooms.size()) {
+        in.fail();
+    }
+    lives = in.readInt();
+    score = in.readInt();
+    furthestRoomIndex = in.readInt();
+    
+    for (int r = 0; r < (int)rooms.size() && !in.hasFailed(); r++) {
+        rooms[r]->readState(in);
+    }
+    
+    for (const auto& player : players) {
+        player->setPosition(in.readPoint());
+        player->setDirection((Direction)in.readInt());
+        player->setRoomIndex(in.readInt());
+        player->setReachedEnd(in.readBool());
+        Direction springDir = (Direction)in.readInt();
+        int velocity = in.readInt();
+        player->setSpringEffect(springDir, velocity, in.readInt());
+        
+        int itemRoom = in.readInt();
+        int itemIndex = in.readInt();
+        bool hasItem = itemRoom >= 0 && itemRoom < (int)rooms.size();
+        player->pickUpItem(hasItem ? rooms[itemRoom]->getElementByIndex(itemIndex) : nullptr, itemRoom, itemIndex);
+        if (player->getRoomIndex() < 0 || player->getRoomIndex() >= (int)rooms.size()) {
+            in.fail();
+        }
+        if (in.hasFailed()) break;
+    }
+    
+    // Queued handlers replace whatever was posted before the restore
+    if (!in.hasFailed()) {
+        scripts.readState(in);
+    }
+    
+    // Restored cells don't count as entered
+    for (int i = 0; i < (int)players.size() && i < (int)scriptCells.size(); i++) {
+        scriptRooms[i] = players[i]->getRoomIndex();
+        scriptCells[i] = players[i]->getPosition();
+    }
+    return !in.hasFailed();
+}
+
+// Keys during play, except ESC (pause menu) which only the console loop knows
+bool Game::handleKey(char key) {
+    if (key == Keys::REWIND) {
+        rewindGame(REWIND_STEP_TICKS);
+        return true;
+    }
+    if (key == Keys::LATENCY_OVERLAY) {
+        showLatency = !showLatency;
+        return false;
+    }
+    
+    // Handle riddle solving - accept any key as answer
+    if (activeRiddle) {
+        int riddler = getPlayerIndex(riddlePlayer);
+        if (key == riddleAnswer) {
+            // Correct answer - Move player to riddle position and remove riddle
+            recordEvent(TelemetryType::RIDDLE_SOLVED, riddler, riddlePlayer->getRoomIndex(),
+                        activeRiddle->getPosition());
+            postScriptEvent(ScriptEvent::SOLVED, riddler, riddlePlayer->getRoomIndex(), activeRiddle->getPosition());
+            riddlePlayer->setPosition(activeRiddle->getPosition());
+            getPlayerRoom(riddlePlayer)->markElementAsCollected(activeRiddle);
+            activeRiddle->setActive(false);
+            activeRiddle = nullptr;
+            riddlePlayer = nullptr;
+        } else {
+            // Wrong answer - reduce life
+            lives--;
+            recordEvent(TelemetryType::RIDDLE_FAILED, riddler, riddlePlayer->getRoomIndex(),
+                        activeRiddle->getPosition());
+            postScriptEvent(ScriptEvent::FAILED, riddler, riddlePlayer->getRoomIndex(), activeRiddle->getPosition());
+            recordEvent(TelemetryType::LIFE_LOST, riddler, riddlePlayer->getRoomIndex(),
+                        activeRiddle->getPosition(), '?', lives);
+            activeRiddle->setActive(false);
+            activeRiddle = nullptr;
+            riddlePlayer = nullptr;
+        }
+        return true;
+    }
+    
+    handlePlayerInput(key);
+    return false;
+}
+
+void Game::step() {
+    if (activeRiddle) return;
+    
+    AllocPhaseScope phase(AllocPhase::TICK_START);
+    telemetryTick++;
+    reloadChangedScreens();
+    recordRewindFrame();
+    for (int r = 0; r < (int)rooms.size(); r++) {
+        postScriptEvent(ScriptEvent::TICK, -1, r, Point(0, 0));
+    }
+    if (scriptMessageTicks > 0) scriptMessageTicks--;
+    AllocTracker::setPhase(AllocPhase::PLAYERS);
+    updateAutopilots();
+    updatePlayers();
+    postEnterEvents();
+    AllocTracker::setPhase(AllocPhase::RULES);
+    checkSwitches();
+    checkCollisions();
+    checkDoors();
+    checkSprings();
+    checkRiddles();
+    AllocTracker::setPhase(AllocPhase::ROOMS);
+    updateRooms();
+    recordDetonations();
+    AllocTracker::setPhase(AllocPhase::ENEMIES);
+    checkEnemies();
+    updateSpringEffects();
+    AllocTracker::setPhase(AllocPhase::SCRIPTS);
+    scripts.run(*this, SCRIPT_TICK_BUDGET);
+    if (darkMode) {
+        AllocTracker::setPhase(AllocPhase::LIGHTING);
+        updateLighting();
+    }
+}
+
+// Fresh game driven by a host: no menus, the host calls handleKey, step and composeFrame
+void Game::startHeadless() {
+    resetGame();
+    state = GameState::PLAYING;
+    recordEvent(TelemetryType::GAME_START, -1, 0, Point(0, 0), ' ', playerCount);
+}
+
+// Records every game played from now on (--record)
+void Game::startRecording(const std::string& name) {
+    recorder = std::make_unique<Recorder>(name);
+}
+
+void Game::startNewGame() {
+    resetGame();
+    if (continueFromSave) {
+        continueFromSave = false;
+        loadGame();
+    }
+    recordEvent(TelemetryType::GAME_START, -1, 0, Point(0, 0), ' ', playerCount);
+    latency->reset();
+    inputQueue.clear();
     
     hideCursor();
     clearScreen();
     
     // Game loop
-    while (state == GameState::PLAYING && !(player1ReachedEnd && player2ReachedEnd) && lives > 0) {
+    while (state == GameState::PLAYING && !allPlayersReachedEnd() && lives > 0) {
         // Input
-        if (_kbhit()) {
-            char key = toUpperCase(_getch());
-            
+        AllocTracker::setPhase(AllocPhase::INPUT);
+        queueKeys();
+        char key;
+        if (takeKey(key)) {
             if (key == Keys::ESC) {
+                inputQueue.clear();  // Keys typed after ESC were meant for the pause menu
+                presenter->flush();  // The pause menu writes to the console itself
                 pauseGame();
                 if (state != GameState::PLAYING) break;
                 continue;
             }
             
-            // Handle riddle solving - accept any key as answer
-            if (activeRiddle) {
-                if (key == Keys::SOLVE_RIDDLE) {
-                    // Correct answer - Move player to riddle position and remove riddle
-                    if (riddlePlayer) {
-                        riddlePlayer->setPosition(activeRiddle->getPosition());
-                    }
-                    getCurrentRoom()->markElementAsCollected(activeRiddle);
-                    activeRiddle->setActive(false);
-                    activeRiddle = nullptr;
-                    riddlePlayer = nullptr;
-                } else {
-                    // Wrong answer - reduce life
-                    lives--;
-                    activeRiddle->setActive(false);
-                    activeRiddle = nullptr;
-                    riddlePlayer = nullptr;
-                }
-                continue;
-            }
-            
-            // Don't process movement if riddle is active
-            if (!activeRiddle) {
-                // Try both players
-                handlePlayerInput(player1.get(), key);
-                handlePlayerInput(player2.get(), key);
-            }
+            if (handleKey(key)) continue;
         }
         
-        // Update (skip if riddle is active)
-        if (!activeRiddle) {
-            updatePlayer(player1.get(), player2.get());
-            updatePlayer(player2.get(), player1.get());
-            checkSwitches();
-            checkCollisions();
-            checkDoors();
-            checkSprings();
-            checkRiddles();
-            getCurrentRoom()->updateBombs();
-            updateSpringEffects();
-        }
+        AllocTracker::beginTick();
+        step();
+        latency->markApplied(getMicroseconds());
         
         // Draw
         drawGame();
+        AllocTracker::endTick();
         
-        Sleep(GAME_CYCLE_DELAY);
+        waitForNextCycle();
     }
+    AllocTracker::setPhase(AllocPhase::OUTSIDE_LOOP);
     
     // Victory or Game Over
+    presenter->flush();
+    uint32_t shownFrame, shownAt;
+    presenter->getLastPresented(shownFrame, shownAt);
+    latency->markPresented(shownFrame, shownAt);
+    latency->writeReport(LATENCY_FILE, playerCount);
+    AllocTracker::writeReport(ALLOC_REPORT_FILE);
     clearScreen();
-    if (player1ReachedEnd && player2ReachedEnd) {
+    if (allPlayersReachedEnd()) {
         gotoxy(30, 11);
         std::cout << "CONGRATULATIONS! YOU WON!";
         gotoxy(30, 12);
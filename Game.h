@@ -1,8 +1,28 @@
 #pragma once
+#include "GameConfig.h"
 #include "Player.h"
 #include "Room.h"
+#include "MoveResolver.h"
+#include "KeyMap.h"
+#include "FieldOfView.h"
+#include "Autopilot.h"
+#include "WorkerPool.h"
+#include "FrameBuffer.h"
+#include "SaveFile.h"
+#include "RewindBuffer.h"
+#include "ScreenWatcher.h"
+#include "Telemetry.h"
+#include "SharedFrame.h"
+#include "FramePresenter.h"
+#include "LatencyTracker.h"
+#include "Recorder.h"
+#include "ScriptVM.h"
+#include "LevelTable.h"
+#include "SharedLevels.h"
 #include <vector>
 #include <memory>
+#include <string>
+#include <thread>
 
 enum class GameState {
     MENU,
@@ -11,44 +31,178 @@ enum class GameState {
     EXIT
 };
 
-class Game {
+class Game : private ScriptHost {
 private:
-    std::unique_ptr<Player> player1;
-    std::unique_ptr<Player> player2;
+    // Movement plan of one player for the current tick
+    struct StepPlan {
+        int springSteps;     // Forced steps in the spring direction
+        Direction walkDir;   // Own step after the spring steps (NONE = no step)
+        bool halted;         // Launch was stopped, skip the remaining steps
+    };
+    
+    int playerCount;
+    bool headless;  // Run by a host (SessionServer), no console, files or threads
+    SharedLevels* sharedLevels;  // Rooms are built on these when set
+    std::vector<std::unique_ptr<Player>> players;
     std::vector<std::unique_ptr<Room>> rooms;
     std::vector<Point> legendPositions;  // Legend position for each room
-    int currentRoomIndex;
-    bool player1ReachedEnd;
-    bool player2ReachedEnd;
+    
+    // Hot reload: the text each room was built from, edits are diffed against it
+    struct ScreenSource {
+        std::string filename;  // Empty if the room can't be patched (large rooms)
+        std::vector<std::string> lines;
+        TriggerWiring wiring;
+    };
+    std::vector<ScreenSource> screenSources;  // Per room, none when the rooms come from tables
+    std::unique_ptr<ScreenWatcher> screenWatcher;  // Console games reading screen files only
+    int furthestRoomIndex;  // Furthest room any player reached (scored once per room)
     GameState state;
     Riddle* activeRiddle;  // Currently active riddle
     Player* riddlePlayer;  // Player who triggered the riddle
+    std::string riddleQuestion;  // Shown while the riddle is open, scripts can change it
+    char riddleAnswer;
+    bool riddleAsked;  // Set by a script ("ask"), the question says how to answer
     int lives;  // Player lives
     int score;  // Game score
+    KeyMap keyMap;  // key -> (player, action)
+    
+    // Bots: 0 = off, 1..playerCount = that player, playerCount + 1 = all players
+    int autopilotSetting;
+    std::vector<std::unique_ptr<Autopilot>> autopilots;  // Per player, nullptr = keyboard
+    
+    // Dark mode: each player sees what its torch lights
+    bool darkMode;
+    std::vector<FieldOfView> playerViews;
+    std::vector<BitGrid> litCells;         // Per room, seen by any player this tick
+    std::vector<BitGrid> rememberedCells;  // Per room, ever seen by any player (kept when they leave)
+    
+    // Batched movement (scratch buffers reused every tick)
+    MoveResolver moveResolver;
+    std::vector<Player*> moveBatch;
+    std::vector<StepPlan> stepPlans;
+    
+    // Every room keeps simulating, one task per room on the worker pool
+    WorkerPool roomWorkers;
+    std::vector<std::vector<Point>> roomPlayerPositions;  // Per room, enemy targets
+    std::vector<const GameElement*> heldItems;            // Every player's item, their chunks stay loaded
+    
+    // Screen: one viewport per room that has players in it (empty in headless
+    // games, their host composes them into a frame of its own)
+    FrameBuffer frame;
+    std::vector<int> shownRooms;
+    
+    // Quick-save: the blob is built on the game thread, written to disk on this one
+    std::thread saveThread;
+    bool continueFromSave;  // Main menu choice, startNewGame loads the quick-save
     
+    // Rewind: state at the start of each recent cycle
+    RewindBuffer rewindBuffer;
+    StateVector rewindState;  // Scratch, reused every cycle
+    
+    // Analytics events, written to TELEMETRY_FILE off the game thread (not in headless games)
+    std::unique_ptr<Telemetry> telemetry;
+    uint32_t telemetryTick;  // Cycles since the game started
+    std::vector<Point> detonations;  // Scratch, collected from the rooms every cycle
+    
+    // Console output runs on the presenter's thread (not in headless games)
+    std::unique_ptr<FramePresenter> presenter;
+    // Console frame shared with --watch spectators (not in headless games)
+    std::unique_ptr<SharedFramePublisher> spectatorFrame;
+    
+    // Key-to-screen latency (not in headless games). Keys are read and stamped
+    // while the loop waits, and still handled one per cycle.
+    struct TimedKey {
+        char key;
+        uint32_t arrived;
+    };
+    std::vector<TimedKey> inputQueue;
+    std::unique_ptr<LatencyTracker> latency;
+    bool showLatency;  // Overlay, toggled with Keys::LATENCY_OVERLAY
+    
+    std::unique_ptr<Recorder> recorder;  // Only while recording (--record)
+    
+    // Room scripts (adv-world_NN.script), not in built-in or headless levels
+    ScriptVM scripts;
+    std::vector<int> scriptRooms;      // Per player, room and cell at the last ENTER event
+    std::vector<Point> scriptCells;
+    std::string scriptMessage;         // Last "say", shown for scriptMessageTicks cycles
+    int scriptMessageTicks;
+    
+    void resetGame();
+    void saveGame();
+    bool loadGame();  // false (game unchanged) if there's no usable save
+    void recordRewindFrame();
+    void recordEvent(TelemetryType type, int playerIndex, int roomIndex, Point pos, char detail = ' ', int value = 0);
+    void recordDetonations();
+    int getPlayerIndex(const Player* player) const;
+    void rewindGame(int ticks);
+    void writeState(StateWriter& out, bool complete = false) const;  // complete: for saves (Room::writeState)
+    bool readState(StateReader& in);  // In place, also on rooms that were played since
+    void createPlayers();
+    Point getSpawnPoint(int playerIndex) const;
+    bool allPlayersReachedEnd() const;
+    void loadRooms();
     void loadRoomsFromFiles();
-    void handlePlayerInput(Player* player, char key);  // Unified for both players
-    void updatePlayer(Player* player, Player* otherPlayer);  // Unified for both players
+    void loadRoomsFromTables(const LevelTable* tables, int count);
+    void loadRoomScript(int roomIndex, const std::string& screenFile);
+    void addSpringAt(Room* room, const std::vector<std::string>& lines, int x, int y,
+                     std::vector<bool>& springUsed);
+    void reloadChangedScreens();
+    void patchRoom(int roomIndex, const std::vector<std::string>& newLines);
+    void createAutopilots();
+    void setPlayerCount(int count);
+    void handlePlayerInput(char key);
+    void applyAction(Player* player, PlayerAction action);
+    void updateAutopilots();
+    void updatePlayers();  // Moves all players together, no player gets priority
+    void movePlayersInRoom(int roomIndex);
     void checkCollisions();
     void checkDoors();
     void checkRiddles();
     void checkSwitches();
     void checkSprings();
     void updateSpringEffects();
-    void drawGame();
+    void updateLighting();
+    void updateRooms();
+    void checkEnemies();
+    void postEnterEvents();
+    void postScriptEvent(ScriptEvent event, int playerIndex, int roomIndex, Point pos, int value = -1);
+    int getScriptValue(ScriptValue value) override;
+    void runScriptEffect(ScriptOp op, int room, int player, int a, int b, const std::string& text) override;
+    void drawGame();  // composeFrame, then hands it to the presenter
+    void drawLatencyOverlay();
+    void queueKeys();
+    bool takeKey(char& key);
+    void waitForNextCycle();  // GAME_CYCLE_DELAY, stamping keys as they come in
+    Viewport getViewport(int view, int viewCount) const;
     void showMenu();
     void showInstructions();
+    void showControls();
     void pauseGame();
-    void drawRiddleOverlay();
+    void drawRiddleOverlay(FrameBuffer& target);
     
 public:
-    Game();
+    // With sharedLevels the game is headless: the rooms are built on those
+    // tables and layouts (kept alive by the caller) and a host drives it
+    // through the functions below instead of run()
+    Game(int numPlayers = DEFAULT_PLAYER_COUNT, SharedLevels* sharedLevels = nullptr);
     
     // Prevent copying (as requested by grader)
     Game(const Game&) = delete;
     Game& operator=(const Game&) = delete;
+    ~Game();
     
     void run();
     void startNewGame();
-    Room* getCurrentRoom() { return rooms[currentRoomIndex].get(); }
+    
+    // One step of the game loop, also used by hosts of headless games
+    void startHeadless();
+    void startRecording(const std::string& name);  // Every game from now on, to <name>.cast / .rec
+    bool handleKey(char key);  // True if the key took the place of this cycle (rewind, riddle answer)
+    void step();               // One cycle, nothing moves while a riddle is open
+    void composeFrame(FrameBuffer& target);  // Draws the current state into target
+    bool isOver() const { return allPlayersReachedEnd() || lives <= 0; }
+    bool hasWon() const { return allPlayersReachedEnd(); }
+    int getScore() const { return score; }
+    Room* getPlayerRoom(const Player* player) { return rooms[player->getRoomIndex()].get(); }
 };
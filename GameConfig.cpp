@@ -43,3 +43,14 @@ char toUpperCase(char c) {
     }
     return c;
 }
+
+uint32_t getMicroseconds() {
+    static LARGE_INTEGER frequency = [] {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return value;
+    }();
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint32_t)(counter.QuadPart / (frequency.QuadPart / 1000000));
+}
@@ -1,7 +1,11 @@
 #pragma once
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN  // Keeps the old winsock.h out, SessionServer uses winsock2.h
+#endif
 #include <windows.h>
 #include <conio.h>
 #include <iostream>
+#include <cstdint>
 
 // Screen constants
 const int SCREEN_WIDTH = 80;
@@ -9,6 +13,96 @@ const int SCREEN_HEIGHT = 25;
 const int SCREEN_OFFSET_Y = 3;  // Game area starts 3 lines down
 const int GAME_CYCLE_DELAY = 120;
 
+// Rooms larger than the screen are stored and loaded in square chunks
+const int CHUNK_SIZE = 32;
+const int BITGRID_DENSE_CHUNKS = 8;  // Bit grids this small are allocated whole (BitGrid.h)
+const int BITGRID_IDLE_CLEARS = 64;  // Larger ones free a chunk left empty this many clears in a row
+
+// Room sizes with their own compiled grid (RoomGrid.h), other sizes are chunked
+const int PUZZLE_ROOM_WIDTH = 40;   // Small puzzle rooms
+const int PUZZLE_ROOM_HEIGHT = 25;  // Every spawn point fits
+const int ARENA_ROOM_WIDTH = 160;   // Wide arenas, two screens side by side
+const int ARENA_ROOM_HEIGHT = 25;
+
+// Split screen: two rooms side by side (false) or one above the other (true)
+const bool SPLIT_SCREEN_STACKED = false;
+
+// Player count (--players N or the main menu), players without keys are driven by the autopilot
+const int DEFAULT_PLAYER_COUNT = 2;
+const int MAX_PLAYERS = 16;
+
+// Dark mode light radius
+const int TORCH_RADIUS = 8;
+const int DARK_RADIUS = 1;  // Without a torch you only see next to you
+
+// Enemies
+const int ENEMY_MOVE_INTERVAL = 2;   // Enemies move every 2nd cycle
+const int ENEMY_RESPAWN_DELAY = 10;  // Cycles an enemy waits at its spawn after a hit
+
+// Autopilot
+const int BOT_PLAN_BUDGET_MICROS = 500;  // Path search time per bot per cycle
+const int BOT_PUSH_COST = 2;             // Pushing an obstacle vs. a plain step
+const int BOT_DETOUR_COST = 10;          // Cells the bot would rather not step on
+
+// Rewind (R): the last REWIND_TICKS cycles are kept, one press goes back REWIND_STEP_TICKS
+const int REWIND_TICKS = 250;               // 30 seconds
+const int REWIND_STEP_TICKS = 25;           // 3 seconds
+const int REWIND_KEYFRAME_INTERVAL = 50;    // Full state every 50 cycles, deltas in between
+const int REWIND_DELTA_CAPACITY = 256;      // Values reserved per delta, bigger ones become keyframes
+
+// Chunks of large rooms no camera or player has been near for this long are
+// unloaded. Not less than REWIND_TICKS: a chunk loaded back by a rewind starts
+// from its last unload, so it must not have changed since the rewound-to cycle.
+const int CHUNK_UNLOAD_TICKS = REWIND_TICKS;
+
+// Key bindings file (defaults below are used when it's missing)
+const char* const KEYMAP_FILE = "keys.cfg";
+
+// Quick-save file (pause menu S / L, main menu option 4)
+const char* const SAVE_FILE = "quicksave.bin";
+
+// Gameplay telemetry (read with TelemetryReader), written by a background thread
+const char* const TELEMETRY_FILE = "telemetry.bin";
+const int TELEMETRY_RING_SIZE = 4096;      // Events in flight, must be a power of 2; more are dropped
+const int TELEMETRY_FLUSH_MILLIS = 250;    // Writer sleep when there's nothing to write
+
+// Session server (--serve) and its thin clients (--connect)
+const char* const SESSION_SOCKET = "game.sock";  // Unix domain socket path
+const int SESSION_MAX_PENDING_KEYS = 16;         // Per client, one key is applied per cycle
+const int SESSION_RUN_MERGE_GAP = 3;             // Unchanged cells a frame run may span
+
+// Spectators (--watch) read the screen of a running game from shared memory
+const char* const SPECTATOR_FRAME_NAME = "Local\\TextAdventureGameFrame";
+const int SPECTATOR_READ_TRIES = 4;     // Reads that may hit a frame being written, per poll
+const int SPECTATOR_POLL_MILLIS = 15;
+
+// Key-to-screen latency, per player and action
+const char* const LATENCY_FILE = "latency.txt";  // Written when a game ends
+const int LATENCY_BUCKET_MILLIS = 5;
+const int LATENCY_BUCKET_COUNT = 100;   // The last bucket also takes everything slower
+const int INPUT_POLL_MILLIS = 5;        // Keys are stamped this often while the loop waits
+
+// Recording (--record): <name>.cast (asciicast v2) and <name>.rec (seekable, --replay)
+const char* const RECORDING_NAME = "recording";
+const int RECORDING_RING_SIZE = 32;          // Frames waiting for the writer, power of 2
+const int RECORDING_KEYFRAME_INTERVAL = 64;  // Written frames between full frames in .rec
+const int RECORDING_FLUSH_MILLIS = 100;      // Writer sleep when there's nothing to write
+
+// Room scripts (Script.h)
+const int SCRIPT_TICK_BUDGET = 2000;     // Instructions per game cycle, the rest waits for the next one
+const int SCRIPT_CALL_LIMIT = 100000;    // A handler running longer than this is stopped
+const int SCRIPT_MAX_PENDING = 256;      // Handlers waiting to run, more events are dropped
+const int SCRIPT_MESSAGE_TICKS = 25;     // How long a "say" message stays up
+
+// Room generator (--generate, LevelGenerator.h)
+const int GENERATOR_ROOM_COUNT = 99;     // Default room count, the game loads up to 99
+const char* const GENERATOR_DIRECTORY = "generated";
+const int GENERATOR_ATTEMPTS = 16;       // Layouts tried per room before the open fallback
+
+// Allocation tracking builds (AllocCheck / AllocStrict, AllocTracker.h)
+const char* const ALLOC_REPORT_FILE = "allocations.txt";  // Written when a game ends
+const int ALLOC_WARMUP_TICKS = 20;       // Ticks that may still grow buffers after a change
+
 // Player control keys
 namespace Keys {
     // Player 1
@@ -27,9 +121,21 @@ namespace Keys {
     const char P2_STAY = 'K';
     const char P2_DISPOSE = 'O';
     
+    // Player 3
+    const char P3_UP = 'T';
+    const char P3_DOWN = 'B';
+    const char P3_LEFT = 'F';
+    const char P3_RIGHT = 'H';
+    const char P3_STAY = 'G';
+    const char P3_DISPOSE = 'Y';
+    
     // System
     const char ESC = 27;
     const char HOME = 'H';
+    const char QUICK_SAVE = 'S';  // In the pause menu
+    const char QUICK_LOAD = 'L';
+    const char REWIND = 'R';
+    const char LATENCY_OVERLAY = '`';  // Shows / hides the key-to-screen latency numbers
     
     // Riddle
     const char SOLVE_RIDDLE = '4';
@@ -39,6 +145,7 @@ namespace Keys {
 namespace Chars {
     const char PLAYER1 = '$';
     const char PLAYER2 = '&';
+    const char PLAYER_SYMBOLS[MAX_PLAYERS + 1] = "$&%+=~^:;<>()[]{";  // Player N uses symbol N
     const char WALL = 'W';
     const char KEY = 'K';
     const char DOOR_BASE = '1'; // 1-9
@@ -49,6 +156,7 @@ namespace Chars {
     const char SWITCH_OFF = '\\';
     const char SWITCH_ON = '/';
     const char SPRING = '#';
+    const char ENEMY = 'E';
 }
 
 // Utility functions
@@ -57,3 +165,4 @@ void clearScreen();
 void hideCursor();
 void showCursor();
 char toUpperCase(char c);
+uint32_t getMicroseconds();  // Steady clock, wraps every ~71 minutes (use differences only)
@@ -0,0 +1,166 @@
+#include "KeyMap.h"
+#include <fstream>
+#include <sstream>
+
+KeyMap::KeyMap() {
+    setDefaults();
+}
+
+void KeyMap::clear() {
+    for (int i = 0; i < 256; i++) {
+        table[i].player = NO_PLAYER;
+        table[i].action = PlayerAction::NONE;
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int a = 0; a < PLAYER_ACTION_COUNT; a++) {
+            keys[p][a] = 0;
+        }
+    }
+}
+
+void KeyMap::setDefaults() {
+    clear();
+
+    // Player 1
+    bind(0, PlayerAction::UP, Keys::P1_UP);
+    bind(0, PlayerAction::DOWN, Keys::P1_DOWN);
+    bind(0, PlayerAction::LEFT, Keys::P1_LEFT);
+    bind(0, PlayerAction::RIGHT, Keys::P1_RIGHT);
+    bind(0, PlayerAction::STAY, Keys::P1_STAY);
+    bind(0, PlayerAction::DISPOSE, Keys::P1_DISPOSE);
+
+    // Player 2
+    bind(1, PlayerAction::UP, Keys::P2_UP);
+    bind(1, PlayerAction::DOWN, Keys::P2_DOWN);
+    bind(1, PlayerAction::LEFT, Keys::P2_LEFT);
+    bind(1, PlayerAction::RIGHT, Keys::P2_RIGHT);
+    bind(1, PlayerAction::STAY, Keys::P2_STAY);
+    bind(1, PlayerAction::DISPOSE, Keys::P2_DISPOSE);
+
+    // Player 3
+    bind(2, PlayerAction::UP, Keys::P3_UP);
+    bind(2, PlayerAction::DOWN, Keys::P3_DOWN);
+    bind(2, PlayerAction::LEFT, Keys::P3_LEFT);
+    bind(2, PlayerAction::RIGHT, Keys::P3_RIGHT);
+    bind(2, PlayerAction::STAY, Keys::P3_STAY);
+    bind(2, PlayerAction::DISPOSE, Keys::P3_DISPOSE);
+}
+
+bool KeyMap::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Strip comments
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+
+        std::istringstream words(line);
+        int player;
+        std::string actionName, keyName;
+        if (!(words >> player >> actionName >> keyName)) {
+            continue;  // Empty or broken line
+        }
+
+        PlayerAction action = PlayerAction::NONE;
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            if (actionName == getActionName((PlayerAction)a)) {
+                action = (PlayerAction)a;
+            }
+        }
+
+        char key = (keyName == "SPACE") ? ' ' : keyName[0];
+        bind(player - 1, action, key);  // Players are 1-based in the file
+    }
+
+    return true;
+}
+
+bool KeyMap::saveToFile(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "# <player> <action> <key>\n";
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            char key = keys[p][a];
+            if (key == 0) continue;
+
+            file << (p + 1) << " " << getActionName((PlayerAction)a) << " ";
+            if (key == ' ') {
+                file << "SPACE";
+            } else {
+                file << key;
+            }
+            file << "\n";
+        }
+    }
+
+    return true;
+}
+
+bool KeyMap::bind(int player, PlayerAction action, char key) {
+    if (player < 0 || player >= MAX_PLAYERS) return false;
+    if (action == PlayerAction::NONE || action == PlayerAction::COUNT) return false;
+
+    key = toUpperCase(key);
+    if (isReservedKey(key)) return false;
+
+    // Free the key from its previous owner
+    KeyBinding& entry = table[(unsigned char)key];
+    if (entry.player != NO_PLAYER) {
+        keys[entry.player][(int)entry.action] = 0;
+    }
+
+    // Free the action's previous key
+    char oldKey = keys[player][(int)action];
+    if (oldKey != 0) {
+        table[(unsigned char)oldKey].player = NO_PLAYER;
+        table[(unsigned char)oldKey].action = PlayerAction::NONE;
+    }
+
+    entry.player = (unsigned char)player;
+    entry.action = action;
+    keys[player][(int)action] = key;
+    return true;
+}
+
+char KeyMap::getKey(int player, PlayerAction action) const {
+    if (player < 0 || player >= MAX_PLAYERS) return 0;
+    return keys[player][(int)action];
+}
+
+bool KeyMap::hasKeys(int player) const {
+    if (player < 0 || player >= MAX_PLAYERS) return false;
+    for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+        if (keys[player][a] != 0) return true;
+    }
+    return false;
+}
+
+const char* KeyMap::getActionName(PlayerAction action) {
+    switch (action) {
+        case PlayerAction::UP: return "UP";
+        case PlayerAction::DOWN: return "DOWN";
+        case PlayerAction::LEFT: return "LEFT";
+        case PlayerAction::RIGHT: return "RIGHT";
+        case PlayerAction::STAY: return "STAY";
+        case PlayerAction::DISPOSE: return "DISPOSE";
+        default: return "NONE";
+    }
+}
+
+// System keys can't be taken by a player
+bool KeyMap::isReservedKey(char key) {
+    return key == 0 || key == Keys::ESC || key == Keys::REWIND || key == Keys::LATENCY_OVERLAY ||
+           key == '\r' || key == '\n';
+}
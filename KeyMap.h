@@ -0,0 +1,54 @@
+#pragma once
+#include "GameConfig.h"
+#include <string>
+
+enum class PlayerAction : unsigned char {
+    NONE = 0,
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT,
+    STAY,
+    DISPOSE,
+    COUNT
+};
+
+const int PLAYER_ACTION_COUNT = (int)PlayerAction::COUNT;
+
+struct KeyBinding {
+    unsigned char player;  // KeyMap::NO_PLAYER when the key is unbound
+    PlayerAction action;
+};
+
+// Maps every key straight to (player, action) with a 256 entry table,
+// so handling a key press is a single lookup no matter how many players there are.
+// Keys are stored upper case (input goes through toUpperCase first).
+class KeyMap {
+public:
+    static const unsigned char NO_PLAYER = 0xFF;
+
+private:
+    KeyBinding table[256];
+    char keys[MAX_PLAYERS][PLAYER_ACTION_COUNT];  // Reverse lookup, 0 = unbound
+
+public:
+    KeyMap();
+
+    void clear();
+    void setDefaults();
+
+    // File format: one "<player> <ACTION> <key>" per line, # starts a comment.
+    // Returns false if the file can't be opened (bindings are left untouched).
+    bool loadFromFile(const std::string& filename);
+    bool saveToFile(const std::string& filename) const;
+
+    const KeyBinding& lookup(char key) const { return table[(unsigned char)key]; }
+
+    // Binds key to the player's action, unbinding whatever used that key before
+    bool bind(int player, PlayerAction action, char key);
+    char getKey(int player, PlayerAction action) const;
+    bool hasKeys(int player) const;  // Any action bound
+
+    static const char* getActionName(PlayerAction action);
+    static bool isReservedKey(char key);
+};
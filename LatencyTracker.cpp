@@ -0,0 +1,164 @@
+#include "LatencyTracker.h"
+#include <fstream>
+#include <algorithm>
+
+void LatencyHistogram::clear() {
+    std::fill(buckets, buckets + LATENCY_BUCKET_COUNT, 0);
+    count = 0;
+    totalMicros = 0;
+    waitMicros = 0;
+    maxMicros = 0;
+}
+
+void LatencyHistogram::add(uint32_t micros, uint32_t waitedMicros) {
+    int bucket = std::min((int)(micros / (LATENCY_BUCKET_MILLIS * 1000)), LATENCY_BUCKET_COUNT - 1);
+    buckets[bucket]++;
+    count++;
+    totalMicros += micros;
+    waitMicros += waitedMicros;
+    maxMicros = std::max(maxMicros, micros);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    totalMicros += other.totalMicros;
+    waitMicros += other.waitMicros;
+    maxMicros = std::max(maxMicros, other.maxMicros);
+}
+
+int LatencyHistogram::getPercentileMillis(int percent) const {
+    if (count == 0) return 0;
+    
+    uint64_t wanted = ((uint64_t)count * percent + 99) / 100;  // Rounded up, at least one input
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT - 1; i++) {
+        seen += buckets[i];
+        if (seen >= wanted) return std::min((i + 1) * LATENCY_BUCKET_MILLIS, (int)(maxMicros / 1000));
+    }
+    return (int)(maxMicros / 1000);  // Slowest bucket is open ended
+}
+
+LatencyTracker::LatencyTracker()
+    : arrival(0), hasArrival(false), histograms(MAX_PLAYERS * PLAYER_ACTION_COUNT) {
+    reset();
+}
+
+void LatencyTracker::reset() {
+    hasArrival = false;
+    pending.clear();
+    for (LatencyHistogram& histogram : histograms) {
+        histogram.clear();
+    }
+}
+
+void LatencyTracker::keyArrived(uint32_t at) {
+    arrival = at;
+    hasArrival = true;
+}
+
+void LatencyTracker::tagInput(int player, PlayerAction action) {
+    if (!hasArrival) return;  // Not a key from the console
+    hasArrival = false;
+    
+    PendingInput input;
+    input.arrived = arrival;
+    input.applied = 0;
+    input.frame = 0;
+    input.player = (unsigned char)player;
+    input.action = action;
+    input.isApplied = false;
+    pending.push_back(input);
+}
+
+void LatencyTracker::markApplied(uint32_t at) {
+    hasArrival = false;  // Keys nobody tagged (rewind, riddle answers) aren't measured
+    for (PendingInput& input : pending) {
+        if (!input.isApplied) {
+            input.applied = at;
+            input.isApplied = true;
+        }
+    }
+}
+
+void LatencyTracker::markSubmitted(uint32_t frameNumber) {
+    for (PendingInput& input : pending) {
+        if (input.isApplied && input.frame == 0) {
+            input.frame = frameNumber;
+        }
+    }
+}
+
+// A skipped frame's inputs show up first in the next frame that was written,
+// which is the one reported here
+void LatencyTracker::markPresented(uint32_t frameNumber, uint32_t at) {
+    size_t done = 0;
+    while (done < pending.size() && pending[done].frame != 0 && pending[done].frame <= frameNumber) {
+        const PendingInput& input = pending[done];
+        histograms[input.player * PLAYER_ACTION_COUNT + (int)input.action]
+            .add(at - input.arrived, input.applied - input.arrived);
+        done++;
+    }
+    pending.erase(pending.begin(), pending.begin() + done);
+}
+
+LatencyHistogram LatencyTracker::getPlayerTotal(int player) const {
+    LatencyHistogram total;
+    total.clear();
+    for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+        total.merge(getHistogram(player, (PlayerAction)a));
+    }
+    return total;
+}
+
+static void writeLine(std::ofstream& file, const std::string& player, const std::string& action,
+                      const LatencyHistogram& histogram) {
+    file << player << "\t" << action << "\t" << histogram.count
+         << "\t" << histogram.totalMicros / 1000 / histogram.count
+         << "\t" << histogram.waitMicros / 1000 / histogram.count
+         << "\t" << histogram.getPercentileMillis(50)
+         << "\t" << histogram.getPercentileMillis(95)
+         << "\t" << histogram.getPercentileMillis(99)
+         << "\t" << histogram.maxMicros / 1000 << "\n";
+}
+
+bool LatencyTracker::writeReport(const std::string& filename, int playerCount) const {
+    std::ofstream file(filename);
+    if (!file) return false;
+    
+    file << "# Key to screen latency in milliseconds: arrival of the key until the console\n";
+    file << "# shows its effect. wait = mean time until the update applied it.\n";
+    file << "player\taction\tcount\tmean\twait\tp50\tp95\tp99\tmax\n";
+    for (int p = 0; p < playerCount; p++) {
+        LatencyHistogram total = getPlayerTotal(p);
+        if (total.count == 0) continue;
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            const LatencyHistogram& histogram = getHistogram(p, (PlayerAction)a);
+            if (histogram.count > 0) {
+                writeLine(file, std::to_string(p + 1), KeyMap::getActionName((PlayerAction)a), histogram);
+            }
+        }
+        writeLine(file, std::to_string(p + 1), "ALL", total);
+    }
+    
+    // Buckets as <from>-<to>:<count>
+    file << "\n# Histograms, " << LATENCY_BUCKET_MILLIS << " ms buckets (the last one is open ended)\n";
+    for (int p = 0; p < playerCount; p++) {
+        for (int a = 1; a < PLAYER_ACTION_COUNT; a++) {
+            const LatencyHistogram& histogram = getHistogram(p, (PlayerAction)a);
+            if (histogram.count == 0) continue;
+            
+            file << (p + 1) << "\t" << KeyMap::getActionName((PlayerAction)a);
+            for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+                if (histogram.buckets[i] == 0) continue;
+                file << "\t" << i * LATENCY_BUCKET_MILLIS << "-";
+                if (i < LATENCY_BUCKET_COUNT - 1) file << (i + 1) * LATENCY_BUCKET_MILLIS;
+                file << ":" << histogram.buckets[i];
+            }
+            file << "\n";
+        }
+    }
+    return true;
+}
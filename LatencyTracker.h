@@ -0,0 +1,63 @@
+#pragma once
+#include "GameConfig.h"
+#include "KeyMap.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Key-to-screen times of one player's action, in LATENCY_BUCKET_MILLIS buckets
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_BUCKET_COUNT];
+    uint32_t count;
+    uint64_t totalMicros;
+    uint64_t waitMicros;  // Part of the total spent before the update applied the key
+    uint32_t maxMicros;
+
+    void clear();
+    void add(uint32_t micros, uint32_t waitedMicros);
+    void merge(const LatencyHistogram& other);
+    // Upper edge of the bucket the percent-th input falls in (at most the max), in milliseconds
+    int getPercentileMillis(int percent) const;
+};
+
+// Follows player keys from arrival to the first frame on the console that
+// shows their effect. The game loop stamps the key on arrival (keyArrived),
+// handlePlayerInput tags it with the player and action, the update applying
+// it marks it applied, the frame composed right after gets its number
+// (markSubmitted), and the presenter reporting that frame as written closes
+// it (markPresented). Game thread only.
+class LatencyTracker {
+private:
+    struct PendingInput {
+        uint32_t arrived;
+        uint32_t applied;
+        uint32_t frame;  // 0 until the frame with its effect is submitted
+        unsigned char player;
+        PlayerAction action;
+        bool isApplied;
+    };
+
+    uint32_t arrival;  // Of the key being handled
+    bool hasArrival;
+    std::vector<PendingInput> pending;  // Oldest first
+    std::vector<LatencyHistogram> histograms;  // [player * PLAYER_ACTION_COUNT + action]
+
+public:
+    LatencyTracker();
+
+    void reset();
+
+    void keyArrived(uint32_t at);
+    void tagInput(int player, PlayerAction action);
+    void markApplied(uint32_t at);
+    void markSubmitted(uint32_t frameNumber);
+    void markPresented(uint32_t frameNumber, uint32_t at);
+
+    const LatencyHistogram& getHistogram(int player, PlayerAction action) const {
+        return histograms[player * PLAYER_ACTION_COUNT + (int)action];
+    }
+    LatencyHistogram getPlayerTotal(int player) const;
+
+    // Text table plus the non-empty buckets, one player and action per line
+    bool writeReport(const std::string& filename, int playerCount) const;
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include "Point.h"
+#include "Direction.h"
+
+// Character rules of screen files, shared by every loader: the screen file
+// loader (Game::loadRoomsFromFiles), large rooms (ChunkedLevel) and the
+// levels compiled into kiosk builds (EmbeddedLevels.h). Everything here is
+// constexpr so that kiosk builds can apply the same rules at compile time.
+
+enum class ElementKind {
+    NONE,      // Floor (' ', '.')
+    WALL,
+    KEY,
+    TORCH,
+    BOMB,
+    OBSTACLE,
+    RIDDLE,
+    SWITCH,
+    SPRING,
+    ENEMY,
+    DOOR,      // '1'-'9', the digit is the target room
+    LEGEND,    // 'L' marks where the legend is drawn
+    UNKNOWN
+};
+
+constexpr ElementKind getElementKind(char ch) {
+    switch (ch) {
+        case ' ':
+        case '.':  return ElementKind::NONE;
+        case 'W':  return ElementKind::WALL;
+        case 'K':  return ElementKind::KEY;
+        case '!':  return ElementKind::TORCH;
+        case '@':  return ElementKind::BOMB;
+        case '*':  return ElementKind::OBSTACLE;
+        case '?':  return ElementKind::RIDDLE;
+        case '\\':  // OFF
+        case '/':  return ElementKind::SWITCH;  // ON - treated the same as OFF initially
+        case '#':  return ElementKind::SPRING;
+        case 'E':  return ElementKind::ENEMY;
+        case 'L':  return ElementKind::LEGEND;
+        default:
+            return (ch >= '1' && ch <= '9') ? ElementKind::DOOR : ElementKind::UNKNOWN;
+    }
+}
+
+// Where each player starts in every room: columns of 6, two rows apart,
+// P1 (5,10), P2 (5,12), ...
+constexpr Point getPlayerSpawnPoint(int playerIndex) {
+    return Point(5 + (playerIndex / 6) * 2, 10 + (playerIndex % 6) * 2);
+}
+
+// One element to create, as read from a level (play-area coordinates)
+struct LevelRecord {
+    ElementKind kind;
+    Point pos;
+    int group;       // Switch group of a switch or door (-1 = none)
+    int value;       // Door: target room, spring: length
+    Direction dir;   // Spring launch direction
+};
+
+// A run of '#' merged into one spring
+struct SpringShape {
+    Point step;       // (1, 0) horizontal or (0, 1) vertical
+    int length;
+    Point anchor;     // End touching the wall
+    Direction launchDir;
+};
+
+// Shape of the spring whose left or top end is first.
+// isFreeSpring(p): p holds a '#' that no other spring took yet, isWall(p): p holds a wall.
+// The run is horizontal if the next char to the right continues it, otherwise vertical.
+// The spring launches away from the wall it leans on.
+template <typename IsFreeSpring, typename IsWall>
+constexpr SpringShape findSpringRun(Point first, IsFreeSpring isFreeSpring, IsWall isWall) {
+    Point step(1, 0);
+    if (!isFreeSpring(first + Point(1, 0)) && isFreeSpring(first + Point(0, 1))) {
+        step = Point(0, 1);
+    }
+    int length = 1;
+    while (isFreeSpring(Point(first.getX() + step.getX() * length, first.getY() + step.getY() * length))) {
+        length++;
+    }
+    
+    Point last(first.getX() + step.getX() * (length - 1), first.getY() + step.getY() * (length - 1));
+    bool horizontal = step.getX() == 1;
+    
+    // Default: anchored at the first end, launching along the run
+    Point anchor = first;
+    Direction launchDir = horizontal ? Direction::RIGHT : Direction::DOWN;
+    
+    if (isWall(first + Point(-step.getX(), -step.getY()))) {
+        anchor = first;
+        launchDir = horizontal ? Direction::RIGHT : Direction::DOWN;
+    } else if (isWall(last + step)) {
+        anchor = last;
+        launchDir = horizontal ? Direction::LEFT : Direction::UP;
+    } else if (length == 1) {
+        // Single char, lean on any neighboring wall
+        if (isWall(first + Point(0, -1))) {
+            launchDir = Direction::DOWN;
+        } else if (isWall(first + Point(0, 1))) {
+            launchDir = Direction::UP;
+        }
+    }
+    
+    return SpringShape{ step, length, anchor, launchDir };
+}
+
+// One wiring line below the play area (see TriggerWiring for the syntax)
+struct WiringLine {
+    enum class Kind {
+        INVALID,
+        SWITCH,      // a, b = x, y   group
+        DOOR,        // a = digit     group
+        OPEN_WALL,   // a, b = x, y   group
+        ARM_BOMB     // a, b = x, y   group
+    };
+    
+    Kind kind;
+    int a;
+    int b;
+    int group;
+};
+
+namespace LevelText {
+    constexpr bool isSpace(char ch) { return ch == ' ' || ch == '\t' || ch == '\r'; }
+    
+    constexpr int skipSpaces(const char* text, int length, int i) {
+        while (i < length && isSpace(text[i])) i++;
+        return i;
+    }
+    
+    // Word at i equals word (and ends there), returns the index after it or -1
+    constexpr int matchWord(const char* text, int length, int i, const char* word) {
+        i = skipSpaces(text, length, i);
+        int k = 0;
+        while (word[k] != '\0') {
+            if (i + k >= length || text[i + k] != word[k]) return -1;
+            k++;
+        }
+        if (i + k < length && !isSpace(text[i + k])) return -1;
+        return i + k;
+    }
+    
+    // Optionally signed integer at i, returns the index after it or -1
+    constexpr int readNumber(const char* text, int length, int i, int& value) {
+        i = skipSpaces(text, length, i);
+        bool negative = false;
+        if (i < length && (text[i] == '-' || text[i] == '+')) {
+            negative = text[i] == '-';
+            i++;
+        }
+        if (i >= length || text[i] < '0' || text[i] > '9') return -1;
+        value = 0;
+        while (i < length && text[i] >= '0' && text[i] <= '9') {
+            value = value * 10 + (text[i] - '0');
+            i++;
+        }
+        if (negative) value = -value;
+        return i;
+    }
+    
+    constexpr bool isBlank(const char* text, int length) {
+        return skipSpaces(text, length, 0) == length;
+    }
+}
+
+// Parses one wiring line, anything after the last number is ignored
+constexpr WiringLine parseWiringLine(const char* text, int length) {
+    using namespace LevelText;
+    WiringLine line{ WiringLine::Kind::INVALID, 0, 0, 0 };
+    int i = 0;
+    
+    if ((i = matchWord(text, length, 0, "switch")) >= 0) {
+        if ((i = readNumber(text, length, i, line.a)) < 0 || (i = readNumber(text, length, i, line.b)) < 0 ||
+            readNumber(text, length, i, line.group) < 0 || line.group < 0) {
+            return line;
+        }
+        line.kind = WiringLine::Kind::SWITCH;
+    } else if ((i = matchWord(text, length, 0, "door")) >= 0) {
+        if ((i = readNumber(text, length, i, line.a)) < 0 || readNumber(text, length, i, line.group) < 0 ||
+            line.a < 1 || line.a > 9 || line.group < 0) {
+            return line;
+        }
+        line.kind = WiringLine::Kind::DOOR;
+    } else if ((i = matchWord(text, length, 0, "on")) >= 0) {
+        if ((i = readNumber(text, length, i, line.group)) < 0 || line.group < 0) return line;
+        
+        WiringLine::Kind kind = WiringLine::Kind::INVALID;
+        int next = -1;
+        if ((next = matchWord(text, length, i, "open")) >= 0) {
+            kind = WiringLine::Kind::OPEN_WALL;
+        } else if ((next = matchWord(text, length, i, "arm")) >= 0) {
+            kind = WiringLine::Kind::ARM_BOMB;
+        } else {
+            return line;
+        }
+        if ((next = readNumber(text, length, next, line.a)) < 0 || readNumber(text, length, next, line.b) < 0) {
+            return line;
+        }
+        line.kind = kind;
+    }
+    return line;
+}
@@ -0,0 +1,288 @@
+#include "LevelGenerator.h"
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+
+LevelGenerator::LevelGenerator(uint32_t seed, int playerCount)
+    : seed(seed), playerCount(std::max(1, std::min(playerCount, MAX_PLAYERS))),
+      workers(std::max(1, (int)std::thread::hardware_concurrency()) - 1), rejectedCount(0) {}
+
+// open: only walkable elements and no inner walls, nothing can cut the room in two
+void LevelGenerator::buildRoom(Grid& grid, std::mt19937& random, int roomNumber, bool open) const {
+    auto isSpawn = [&](int x, int y) {
+        for (int i = 0; i < playerCount; i++) {
+            if (getPlayerSpawnPoint(i) == Point(x, y)) return true;
+        }
+        return false;
+    };
+    auto pick = [&](int low, int high) { return low + (int)(random() % (uint32_t)(high - low + 1)); };
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            bool border = x == 0 || y == 0 || x == SCREEN_WIDTH - 1 || y == SCREEN_HEIGHT - 1;
+            grid.cells[y][x] = border ? 'W' : ' ';
+        }
+    }
+    grid.wiring.clear();
+
+    // Wall segments, each with a two cell gap
+    if (!open) {
+        int segments = pick(3, 6);
+        for (int s = 0; s < segments; s++) {
+            bool horizontal = random() % 2 == 0;
+            int length = pick(8, horizontal ? 30 : 15);
+            int x = horizontal ? pick(2, SCREEN_WIDTH - 2 - length) : pick(2, SCREEN_WIDTH - 3);
+            int y = horizontal ? pick(2, SCREEN_HEIGHT - 3) : pick(2, SCREEN_HEIGHT - 2 - length);
+            int gap = pick(0, length - 2);
+            for (int i = 0; i < length; i++) {
+                if (i == gap || i == gap + 1) continue;
+                int cx = horizontal ? x + i : x;
+                int cy = horizontal ? y : y + i;
+                if (!isSpawn(cx, cy)) grid.cells[cy][cx] = 'W';
+            }
+        }
+    }
+
+    auto place = [&](char ch) {
+        while (true) {
+            int x = pick(1, SCREEN_WIDTH - 2);
+            int y = pick(1, SCREEN_HEIGHT - 2);
+            if (grid.cells[y][x] == ' ' && !isSpawn(x, y)) {
+                grid.cells[y][x] = ch;
+                return Point(x, y);
+            }
+        }
+    };
+
+    for (int i = playerCount + pick(0, 1); i > 0; i--) {
+        place('K');
+    }
+    // Players that finish the last room stay on its door, so everyone gets one
+    char doorDigit = (char)('0' + std::min(roomNumber + 1, 9));
+    for (int i = 0; i < playerCount; i++) {
+        place(doorDigit);
+    }
+
+    // Switches wired to the door, the group may also open a wall
+    int switches = pick(0, 3);
+    for (int i = 0; i < switches; i++) {
+        Point pos = place('\\');
+        grid.wiring.push_back("switch " + std::to_string(pos.getX()) + " " + std::to_string(pos.getY()) + " 1");
+    }
+    if (switches > 0) {
+        grid.wiring.push_back(std::string("door ") + doorDigit + " 1");
+        for (int tries = 0; tries < 50 && !open; tries++) {
+            int x = pick(1, SCREEN_WIDTH - 2);
+            int y = pick(1, SCREEN_HEIGHT - 2);
+            if (grid.cells[y][x] == 'W') {
+                grid.wiring.push_back("on 1 open " + std::to_string(x) + " " + std::to_string(y));
+                break;
+            }
+        }
+    }
+
+    for (int i = pick(0, 2); i > 0; i--) place('@');
+    for (int i = pick(0, 1); i > 0; i--) place('!');
+    if (open) return;
+
+    for (int i = pick(0, 4); i > 0; i--) place('*');
+    for (int i = pick(0, 1); i > 0; i--) place('?');
+    for (int i = pick(0, 2); i > 0; i--) placeSpring(grid, random);
+}
+
+// A run of 1-3 '#' leaning on one of the outer walls, not touching other springs
+bool LevelGenerator::placeSpring(Grid& grid, std::mt19937& random) const {
+    int side = (int)(random() % 4);
+    int length = 1 + (int)(random() % 3);
+    bool horizontal = side < 2;  // Left or right wall
+    int along = horizontal ? 1 + (int)(random() % (SCREEN_HEIGHT - 2)) : 1 + (int)(random() % (SCREEN_WIDTH - 2));
+
+    Point first = side == 0 ? Point(1, along) :
+                  side == 1 ? Point(SCREEN_WIDTH - 1 - length, along) :
+                  side == 2 ? Point(along, 1) : Point(along, SCREEN_HEIGHT - 1 - length);
+    Point step = horizontal ? Point(1, 0) : Point(0, 1);
+
+    const Point neighbors[] = { Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1) };
+    for (int i = 0; i < length; i++) {
+        Point pos(first.getX() + step.getX() * i, first.getY() + step.getY() * i);
+        if (grid.cells[pos.getY()][pos.getX()] != ' ') return false;
+        for (int p = 0; p < playerCount; p++) {
+            if (getPlayerSpawnPoint(p) == pos) return false;
+        }
+        for (Point n : neighbors) {
+            if (grid.cells[pos.getY() + n.getY()][pos.getX() + n.getX()] == '#') return false;
+        }
+    }
+    for (int i = 0; i < length; i++) {
+        grid.cells[first.getY() + step.getY() * i][first.getX() + step.getX() * i] = '#';
+    }
+    return true;
+}
+
+std::string LevelGenerator::toScreenText(const Grid& grid, Point legendPos) {
+    std::string text;
+    text.reserve((SCREEN_TOTAL_LINES + grid.wiring.size()) * (SCREEN_WIDTH + 1) + 16 * grid.wiring.size());
+    for (int y = 0; y < SCREEN_OFFSET_Y; y++) {
+        std::string line(SCREEN_WIDTH, ' ');
+        if (y == legendPos.getY()) line[legendPos.getX()] = 'L';
+        text += line;
+        text += '\n';
+    }
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        text.append(grid.cells[y], SCREEN_WIDTH);
+        text += '\n';
+    }
+    for (const std::string& line : grid.wiring) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+std::string LevelGenerator::generateScreen(int index, LevelTable* table) {
+    std::seed_seq sequence{ seed, (uint32_t)index };
+    std::mt19937 random(sequence);
+    Grid grid;
+    LevelTable local;
+    LevelTable& parsed = table ? *table : local;
+
+    for (int attempt = 0; ; attempt++) {
+        bool open = attempt == GENERATOR_ATTEMPTS;
+        buildRoom(grid, random, index + 1, open);
+        // Room for one 10 char legend entry per player
+        int legendWidth = 10 * std::min(playerCount, 8);
+        Point legendPos((int)(random() % (SCREEN_WIDTH - legendWidth + 1)), 0);
+        std::string text = toScreenText(grid, legendPos);
+
+        try {
+            parsed = parseLevel(text.c_str());
+            if (open || isLevelSolvable(parsed, playerCount)) return text;
+        } catch (const char*) {
+            // Counted as rejected like an unsolvable room
+        }
+        rejectedCount++;
+    }
+}
+
+std::vector<std::string> LevelGenerator::generateScreens(int count) {
+    std::vector<std::string> screens(std::max(0, count));
+    workers.runAll(count, [&](int i) { screens[i] = generateScreen(i); });
+    return screens;
+}
+
+std::vector<LevelTable> LevelGenerator::generateTables(int count) {
+    std::vector<LevelTable> tables(std::max(0, count));
+    workers.runAll(count, [&](int i) { generateScreen(i, &tables[i]); });
+    return tables;
+}
+
+bool isLevelSolvable(const LevelTable& level, int playerCount) {
+    const int CELLS = SCREEN_WIDTH * SCREEN_HEIGHT;
+    bool blocked[CELLS] = {};
+    bool reached[CELLS] = {};
+    auto index = [](Point pos) { return pos.getY() * SCREEN_WIDTH + pos.getX(); };
+    auto inside = [](Point pos) {
+        return pos.getX() >= 0 && pos.getX() < SCREEN_WIDTH && pos.getY() >= 0 && pos.getY() < SCREEN_HEIGHT;
+    };
+
+    for (int r = 0; r < level.recordCount; r++) {
+        const LevelRecord& record = level.records[r];
+        switch (record.kind) {
+            case ElementKind::WALL:
+            case ElementKind::OBSTACLE:
+            case ElementKind::RIDDLE:
+                blocked[index(record.pos)] = true;
+                break;
+            case ElementKind::SPRING: {
+                // The run goes from the anchor in the launch direction
+                Point step = directionToPoint(record.dir);
+                for (int i = 0; i < record.value; i++) {
+                    Point pos(record.pos.getX() + step.getX() * i, record.pos.getY() + step.getY() * i);
+                    if (inside(pos)) blocked[index(pos)] = true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Flood fill from the first spawn point
+    Point start = getPlayerSpawnPoint(0);
+    if (blocked[index(start)]) return false;
+    std::vector<Point> queue;
+    queue.reserve(CELLS);
+    queue.push_back(start);
+    reached[index(start)] = true;
+    const Point neighbors[] = { Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1) };
+    for (size_t next = 0; next < queue.size(); next++) {
+        for (Point n : neighbors) {
+            Point pos = queue[next] + n;
+            if (inside(pos) && !blocked[index(pos)] && !reached[index(pos)]) {
+                reached[index(pos)] = true;
+                queue.push_back(pos);
+            }
+        }
+    }
+
+    for (int i = 1; i < playerCount; i++) {
+        if (!reached[index(getPlayerSpawnPoint(i))]) return false;
+    }
+
+    int keys = 0;
+    for (int r = 0; r < level.recordCount; r++) {
+        if (level.records[r].kind == ElementKind::KEY && reached[index(level.records[r].pos)]) keys++;
+    }
+    if (keys < playerCount) return false;  // Every door use costs a key
+
+    // A door with a switch group opens once every switch of the group is ON.
+    // Players that finish the last room stay on its door, each needs its own.
+    int doors = 0;
+    for (int r = 0; r < level.recordCount; r++) {
+        const LevelRecord& door = level.records[r];
+        if (door.kind != ElementKind::DOOR || !reached[index(door.pos)]) continue;
+
+        int switches = 0;
+        bool allReached = true;
+        for (int s = 0; s < level.recordCount && door.group >= 0; s++) {
+            const LevelRecord& record = level.records[s];
+            if (record.kind != ElementKind::SWITCH || record.group != door.group) continue;
+            switches++;
+            allReached = allReached && reached[index(record.pos)];
+        }
+        if (door.group < 0 || (switches > 0 && allReached)) doors++;
+    }
+    return doors >= playerCount;
+}
+
+int runGenerator(int count, uint32_t seed, const std::string& directory, int playerCount) {
+    if (count < 1) {
+        std::cerr << "Error: nothing to generate" << std::endl;
+        return 1;
+    }
+    CreateDirectoryA(directory.c_str(), nullptr);  // Fails harmlessly if it exists
+
+    LevelGenerator generator(seed, playerCount);
+    uint32_t start = getMicroseconds();
+    std::vector<std::string> screens = generator.generateScreens(count);
+    uint32_t elapsed = std::max(1u, getMicroseconds() - start);
+
+    for (int i = 0; i < count; i++) {
+        char filename[32];
+        snprintf(filename, sizeof(filename), "/adv-world_%02d.screen", i + 1);
+        std::ofstream file(directory + filename);
+        file << screens[i];
+        if (!file) {
+            std::cerr << "Error: Could not write " << directory << filename << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Generated " << count << " rooms in " << elapsed / 1000 << " ms ("
+              << (long long)count * 1000000 / elapsed << " rooms/s, " << generator.getRejectedCount()
+              << " layouts rejected), written to " << directory << std::endl;
+    return 0;
+}
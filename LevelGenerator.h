@@ -0,0 +1,59 @@
+#pragma once
+#include "LevelTable.h"
+#include "WorkerPool.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+// Random rooms in the adv-world_NN.screen layout (legend band with L, 80x25
+// play area, wiring lines), built from a seed: walls with gaps, keys, doors,
+// switches wired to the doors, springs, obstacles, bombs, torches and riddles.
+// Every room goes through parseLevel and isLevelSolvable before it's kept;
+// a layout that fails is replaced by the next one from the same seed, and
+// after GENERATOR_ATTEMPTS the room is built without inner walls, which is
+// solvable by construction. Room i of a seed is always the same room, no
+// matter how many threads built it.
+class LevelGenerator {
+private:
+    uint32_t seed;
+    int playerCount;
+    WorkerPool workers;
+    std::atomic<int> rejectedCount;  // Layouts that failed the checks
+
+    struct Grid {
+        char cells[SCREEN_HEIGHT][SCREEN_WIDTH];
+        std::vector<std::string> wiring;
+    };
+
+    void buildRoom(Grid& grid, std::mt19937& random, int roomNumber, bool withWalls) const;
+    bool placeSpring(Grid& grid, std::mt19937& random) const;
+    static std::string toScreenText(const Grid& grid, Point legendPos);
+
+public:
+    explicit LevelGenerator(uint32_t seed, int playerCount = DEFAULT_PLAYER_COUNT);
+
+    // Prevent copying (owns the workers)
+    LevelGenerator(const LevelGenerator&) = delete;
+    LevelGenerator& operator=(const LevelGenerator&) = delete;
+
+    // Screen file text of room index (0-based), optionally its parsed table
+    std::string generateScreen(int index, LevelTable* table = nullptr);
+
+    // count rooms, built on all cores
+    std::vector<std::string> generateScreens(int count);
+    std::vector<LevelTable> generateTables(int count);
+
+    int getRejectedCount() const { return rejectedCount; }
+};
+
+// Conservative check that playerCount players can finish the room without
+// pushing obstacles, riding springs or answering riddles (all three block):
+// every spawn point is connected, and there are enough keys and doors (with
+// all their switches reachable) for everyone
+bool isLevelSolvable(const LevelTable& level, int playerCount);
+
+// --generate: writes count rooms for playerCount players as adv-world_NN.screen
+// into directory and prints how fast they were built. Returns the process exit code.
+int runGenerator(int count, uint32_t seed, const std::string& directory, int playerCount = DEFAULT_PLAYER_COUNT);
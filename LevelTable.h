@@ -0,0 +1,147 @@
+#pragma once
+#include "LevelFormat.h"
+#include "TriggerGraph.h"
+#include "GameConfig.h"
+
+// A screen file parsed into the elements to create, the wiring actions and the
+// legend position, with the same rules as Game::loadRoomsFromFiles. parseLevel
+// is constexpr: kiosk builds run it at compile time (EmbeddedLevels.h), the
+// session server runs it once at startup and shares the tables between games.
+// A broken screen throws a message (a compile error when run by the compiler).
+const int SCREEN_TOTAL_LINES = SCREEN_OFFSET_Y + SCREEN_HEIGHT;  // 3 + 25 = 28
+const int MAX_LEVEL_RECORDS = SCREEN_WIDTH * SCREEN_HEIGHT;
+const int MAX_LEVEL_WIRING = 64;
+
+struct LevelTable {
+    LevelRecord records[MAX_LEVEL_RECORDS];
+    int recordCount;
+    TriggerWiring::ActionEntry actions[MAX_LEVEL_WIRING];
+    int actionCount;
+    Point legendPos;  // File coordinates
+};
+
+namespace LevelText {
+    // Line starts and lengths of one screen ('\r' of CRLF files left out)
+    struct ScreenLines {
+        int start[SCREEN_TOTAL_LINES + MAX_LEVEL_WIRING];
+        int length[SCREEN_TOTAL_LINES + MAX_LEVEL_WIRING];
+        int count;
+    };
+
+    constexpr ScreenLines splitLines(const char* text) {
+        ScreenLines lines{};
+        int i = 0;
+        while (text[i] != '\0') {
+            if (lines.count == SCREEN_TOTAL_LINES + MAX_LEVEL_WIRING) {
+                throw "screen has too many lines";
+            }
+            int end = i;
+            while (text[end] != '\0' && text[end] != '\n') end++;
+
+            lines.start[lines.count] = i;
+            lines.length[lines.count] = (end > i && text[end - 1] == '\r') ? end - 1 - i : end - i;
+            lines.count++;
+            i = text[end] == '\n' ? end + 1 : end;
+        }
+        return lines;
+    }
+
+    // Char at file column x, line y (space when outside the file)
+    constexpr char charAt(const char* text, const ScreenLines& lines, int x, int y) {
+        if (y < 0 || y >= lines.count || x < 0 || x >= lines.length[y]) {
+            return ' ';
+        }
+        return text[lines.start[y] + x];
+    }
+}
+
+constexpr LevelTable parseLevel(const char* text) {
+    LevelTable table{};
+    table.legendPos = Point(2, 1);  // Default legend position
+
+    LevelText::ScreenLines lines = LevelText::splitLines(text);
+    if (lines.count < SCREEN_TOTAL_LINES) {
+        throw "screen has fewer than 28 lines";
+    }
+
+    // Wiring lines below the play area
+    TriggerWiring::SwitchEntry switches[MAX_LEVEL_WIRING] = {};
+    int switchCount = 0;
+    int doorGroups[10] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    for (int y = SCREEN_TOTAL_LINES; y < lines.count; y++) {
+        const char* line = text + lines.start[y];
+        if (LevelText::isBlank(line, lines.length[y])) continue;
+
+        WiringLine wiring = parseWiringLine(line, lines.length[y]);
+        switch (wiring.kind) {
+            case WiringLine::Kind::SWITCH:
+                switches[switchCount++] = { Point(wiring.a, wiring.b), wiring.group };
+                break;
+            case WiringLine::Kind::DOOR:
+                doorGroups[wiring.a] = wiring.group;
+                break;
+            case WiringLine::Kind::OPEN_WALL:
+            case WiringLine::Kind::ARM_BOMB: {
+                TriggerAction action{ wiring.kind == WiringLine::Kind::OPEN_WALL ?
+                                          TriggerAction::Type::OPEN_WALL : TriggerAction::Type::ARM_BOMB,
+                                      Point(wiring.a, wiring.b) };
+                table.actions[table.actionCount++] = { wiring.group, action };
+                break;
+            }
+            default:
+                throw "screen has a wiring line that is not switch, door or on";
+        }
+    }
+
+    // Play area, springs are merged the same way as in Game::addSpringAt
+    bool springUsed[MAX_LEVEL_RECORDS] = {};
+    auto isFreeSpring = [&](Point p) {
+        return p.getX() >= 0 && p.getX() < SCREEN_WIDTH && p.getY() >= 0 && p.getY() < SCREEN_HEIGHT &&
+               LevelText::charAt(text, lines, p.getX(), p.getY() + SCREEN_OFFSET_Y) == '#' &&
+               !springUsed[p.getY() * SCREEN_WIDTH + p.getX()];
+    };
+    auto isWallChar = [&](Point p) {
+        return LevelText::charAt(text, lines, p.getX(), p.getY() + SCREEN_OFFSET_Y) == 'W';
+    };
+
+    for (int y = 0; y < SCREEN_TOTAL_LINES; y++) {
+        if (lines.length[y] > SCREEN_WIDTH) {
+            throw "screen line is wider than 80 chars";
+        }
+        for (int x = 0; x < lines.length[y]; x++) {
+            char ch = LevelText::charAt(text, lines, x, y);
+            ElementKind kind = getElementKind(ch);
+            if (kind == ElementKind::LEGEND) {
+                table.legendPos = Point(x, y);  // Keep file coordinates
+                continue;
+            }
+            if (y < SCREEN_OFFSET_Y || kind == ElementKind::NONE) continue;
+            if (kind == ElementKind::UNKNOWN) {
+                throw "screen has an unknown char in the play area";
+            }
+
+            Point pos(x, y - SCREEN_OFFSET_Y);
+            LevelRecord record{ kind, pos, -1, 0, Direction::NONE };
+            if (kind == ElementKind::SPRING) {
+                if (springUsed[pos.getY() * SCREEN_WIDTH + x]) continue;
+                SpringShape shape = findSpringRun(pos, isFreeSpring, isWallChar);
+                for (int i = 0; i < shape.length; i++) {
+                    springUsed[(pos.getY() + shape.step.getY() * i) * SCREEN_WIDTH + x + shape.step.getX() * i] = true;
+                }
+                record.pos = shape.anchor;
+                record.value = shape.length;
+                record.dir = shape.launchDir;
+            } else if (kind == ElementKind::SWITCH) {
+                record.group = 0;  // Unlisted switches belong to group 0
+                for (int i = 0; i < switchCount; i++) {
+                    if (switches[i].pos == pos) record.group = switches[i].group;
+                }
+            } else if (kind == ElementKind::DOOR) {
+                record.value = ch - '0';  // Target room
+                record.group = doorGroups[record.value];
+            }
+            table.records[table.recordCount++] = record;
+        }
+    }
+    return table;
+}
@@ -0,0 +1,215 @@
+#include "MoveResolver.h"
+#include "Room.h"
+#include "GameConfig.h"
+
+MoveResolver::MoveResolver() : round(0) {}
+
+void MoveResolver::reserve(int playerCount) {
+    int size = 4;
+    while (size < 4 * playerCount) {
+        size *= 2;
+    }
+    cells.assign(size, CellEntry{ Point(0, 0), 0, -1, 0 });
+    round = 0;
+    intents.reserve(playerCount);
+    intentOf.reserve(playerCount);
+    work.reserve(playerCount);
+}
+
+int MoveResolver::hashCell(Point pos) const {
+    unsigned int h = (unsigned int)pos.getX() * 73856093u ^ (unsigned int)pos.getY() * 19349663u;
+    return (int)(h & (cells.size() - 1));
+}
+
+MoveResolver::CellEntry& MoveResolver::cellAt(Point pos) {
+    int slot = hashCell(pos);
+    while (cells[slot].round == round && cells[slot].pos != pos) {
+        slot = (slot + 1) & ((int)cells.size() - 1);
+    }
+    CellEntry& entry = cells[slot];
+    if (entry.round != round) {
+        entry.pos = pos;
+        entry.round = round;
+        entry.occupant = -1;
+        entry.claims = 0;
+    }
+    return entry;
+}
+
+const MoveResolver::CellEntry* MoveResolver::findCell(Point pos) const {
+    for (int slot = hashCell(pos); cells[slot].round == round; slot = (slot + 1) & ((int)cells.size() - 1)) {
+        if (cells[slot].pos == pos) return &cells[slot];
+    }
+    return nullptr;
+}
+
+int MoveResolver::occupantAt(Point pos) const {
+    const CellEntry* entry = findCell(pos);
+    return entry ? entry->occupant : -1;
+}
+
+int MoveResolver::claimsAt(Point pos) const {
+    const CellEntry* entry = findCell(pos);
+    return entry ? entry->claims : 0;
+}
+
+void MoveResolver::begin(int playerCount) {
+    if ((int)cells.size() < 4 * playerCount) {
+        reserve(playerCount);  // More players than reserved for, this round allocates
+    }
+    intents.clear();
+    intentOf.assign(playerCount, -1);
+}
+
+void MoveResolver::addIntent(int playerIndex, Direction dir, StepKind kind) {
+    if (dir == Direction::NONE) return;
+
+    Intent intent;
+    intent.playerIndex = playerIndex;
+    intent.kind = kind;
+    intent.dir = dir;
+    intent.pushed = nullptr;
+    intent.blocked = false;
+    intent.hitPlayer = -1;
+    intent.waiter = -1;
+    intent.velocity = 0;
+
+    intentOf[playerIndex] = (int)intents.size();
+    intents.push_back(intent);
+}
+
+// Checks the target cell against the room only (other players are handled later)
+bool MoveResolver::checkTarget(const Room* room, Intent& intent) const {
+    if (intent.kind == StepKind::WALK) {
+        Obstacle* obs = room->getObstacleAt(intent.to);
+        if (obs) {
+            intent.pushed = obs;
+            intent.pushTo = intent.to + directionToPoint(intent.dir);
+            return room->isPositionWalkable(intent.pushTo) &&
+                   room->getElementAt(intent.pushTo) == nullptr;
+        }
+        return room->isPositionWalkable(intent.to);
+    }
+
+    // Launched players fly over empty cells and springs only, but may hit another player
+    if (occupantAt(intent.to) >= 0) return true;
+    GameElement* elem = room->getElementAt(intent.to);
+    return room->isPositionWalkable(intent.to) && (!elem || room->getSpringAt(intent.to) == elem);
+}
+
+void MoveResolver::resolve(Room* room, const std::vector<Player*>& players) {
+    if (++round == 0) {
+        // Wrapped around, old entries could match again
+        for (CellEntry& entry : cells) {
+            entry.round = 0;
+        }
+        round = 1;
+    }
+
+    // The last player on a cell wins, like several players standing on one door
+    for (int i = 0; i < (int)players.size(); i++) {
+        cellAt(players[i]->getPosition()).occupant = i;
+    }
+
+    // Check targets against the room, the ones that pass claim their cells
+    for (Intent& intent : intents) {
+        intent.from = players[intent.playerIndex]->getPosition();
+        intent.to = intent.from + directionToPoint(intent.dir);
+        if (!checkTarget(room, intent)) {
+            intent.blocked = true;
+            continue;
+        }
+        cellAt(intent.to).claims++;
+        if (intent.pushed) {
+            cellAt(intent.pushTo).claims++;
+        }
+    }
+
+    // Contested cells go to nobody (this also covers two players pushing one obstacle)
+    for (Intent& intent : intents) {
+        if (intent.blocked) continue;
+        if (claimsAt(intent.to) > 1 || (intent.pushed && claimsAt(intent.pushTo) > 1)) {
+            intent.blocked = true;
+        }
+    }
+
+    // Moving into another player's cell depends on that player moving away
+    for (int k = 0; k < (int)intents.size(); k++) {
+        Intent& intent = intents[k];
+        if (intent.blocked) continue;
+
+        if (intent.pushed && occupantAt(intent.pushTo) >= 0) {
+            intent.blocked = true;
+            continue;
+        }
+
+        int other = occupantAt(intent.to);
+        if (other < 0) continue;
+
+        int otherIntent = intentOf[other];
+        if (otherIntent < 0) {
+            intent.blocked = true;
+            intent.hitPlayer = other;
+        } else if (intents[otherIntent].to == intent.from) {
+            intent.blocked = true;  // Swap - players can't walk through each other
+        } else {
+            intents[otherIntent].waiter = k;
+        }
+    }
+
+    // A blocked player stays put, so whoever waits for its cell is blocked too
+    work.clear();
+    for (int k = 0; k < (int)intents.size(); k++) {
+        if (intents[k].blocked) {
+            work.push_back(k);
+        }
+    }
+    while (!work.empty()) {
+        int k = work.back();
+        work.pop_back();
+
+        int w = intents[k].waiter;
+        if (w >= 0 && !intents[w].blocked) {
+            intents[w].blocked = true;
+            intents[w].hitPlayer = intents[k].playerIndex;
+            work.push_back(w);
+        }
+    }
+
+    // Apply all moves together
+    for (Intent& intent : intents) {
+        Player* player = players[intent.playerIndex];
+
+        if (!intent.blocked) {
+            if (intent.pushed && !room->tryPushObstacle(intent.pushed, intent.dir)) {
+                player->stop();
+                continue;
+            }
+            player->setPosition(intent.to);
+        } else if (intent.kind == StepKind::WALK) {
+            player->stop();
+        } else if (intent.kind == StepKind::SPRING) {
+            // Launch ends here - remember its strength in case we pass it on
+            intent.velocity = player->getSpringVelocity();
+            player->stop();
+            player->clearSpringEffect();
+        }
+        // A failed LATERAL step is harmless, the player keeps flying
+    }
+
+    // Launched players that hit someone pass their spring effect on.
+    // Done after all launches ended so a transfer can't be undone by the receiver's own step.
+    for (const Intent& intent : intents) {
+        if (!intent.blocked || intent.kind != StepKind::SPRING || intent.hitPlayer < 0) continue;
+
+        Player* other = players[intent.hitPlayer];
+        other->setSpringEffect(intent.dir, intent.velocity, intent.velocity * intent.velocity);
+        other->stop();
+    }
+}
+
+bool MoveResolver::isBlocked(int playerIndex) const {
+    if (playerIndex < 0 || playerIndex >= (int)intentOf.size()) return false;
+    int k = intentOf[playerIndex];
+    return k >= 0 && intents[k].blocked;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "GameConfig.h"
+#include "Point.h"
+#include "Direction.h"
+#include "Player.h"
+#include <vector>
+
+class Room;
+class Obstacle;
+
+// Resolves one movement step for a whole batch of players at once.
+// Every player first declares where it wants to go, then conflicts are
+// settled using only the set of intents, so the list order never matters:
+//  - two players claiming the same cell (or pushing the same obstacle) both stay
+//  - two players swapping cells both stay
+//  - a player following another player only moves if the leader gets to move
+// A round touches at most three cells per player (where it stands, where it
+// goes, where it pushes to), so cells live in a small hash table sized for the
+// player count rather than in grids of the room's size: lookups stay O(1) and
+// a round never allocates.
+class MoveResolver {
+public:
+    enum class StepKind {
+        WALK,     // normal step, may push an obstacle
+        SPRING,   // forced step of a spring launch
+        LATERAL   // sideways step while launched, failing it is harmless
+    };
+
+private:
+    struct Intent {
+        int playerIndex;
+        StepKind kind;
+        Direction dir;
+        Point from;
+        Point to;
+        Obstacle* pushed;  // Obstacle in the target cell (WALK only)
+        Point pushTo;
+        bool blocked;
+        int hitPlayer;     // Stationary player that blocked us, -1 if none
+        int waiter;        // Intent that wants to enter our cell, -1 if none
+        int velocity;      // Launch velocity when a SPRING step was stopped
+    };
+
+    // Open addressing, linear probing. Entries from earlier rounds count as
+    // empty, so starting a round clears the table by bumping the round number.
+    struct CellEntry {
+        Point pos;
+        unsigned int round;
+        int occupant;  // Player index standing there, -1 if none
+        int claims;    // Intents that want the cell
+    };
+    std::vector<CellEntry> cells;  // Power of 2 size, at most 3/4 full
+    unsigned int round;  // Current round, never 0 (0 marks entries never used)
+
+    std::vector<Intent> intents;
+    std::vector<int> intentOf;          // player index -> intent index (-1 = not moving)
+    std::vector<int> work;              // blocked intents still to propagate
+
+    int hashCell(Point pos) const;
+    CellEntry& cellAt(Point pos);       // Adds the cell if the round hasn't seen it
+    const CellEntry* findCell(Point pos) const;
+    int occupantAt(Point pos) const;    // Player index standing there, -1 if none
+    int claimsAt(Point pos) const;      // Intents that want the cell
+    bool checkTarget(const Room* room, Intent& intent) const;
+
+public:
+    MoveResolver();
+    
+    // Room for batches of up to playerCount players, so that rounds don't allocate
+    void reserve(int playerCount);
+
+    // Start a new round for a batch of the given size
+    void begin(int playerCount);
+    void addIntent(int playerIndex, Direction dir, StepKind kind);
+
+    // Settle all intents of this round and apply them to the players and room
+    void resolve(Room* room, const std::vector<Player*>& players);
+
+    bool isBlocked(int playerIndex) const;
+};
@@ -3,12 +3,14 @@
 #include <iostream>
 
 Player::Player(Point pos, char sym) 
-    : position(pos), direction(Direction::NONE), symbol(sym), heldItem(nullptr),
+    : position(pos), direction(Direction::NONE), symbol(sym), heldItem(nullptr), heldItemRoom(-1), heldItemIndex(-1), reachedEnd(false), roomIndex(0),
       springDirection(Direction::NONE), springVelocity(0), springCyclesRemaining(0) {}
 
 GameElement* Player::disposeItem() {
     GameElement* item = heldItem;
     heldItem = nullptr;
+    heldItemRoom = -1;
+    heldItemIndex = -1;
     return item;
 }
 
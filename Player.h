@@ -9,6 +9,10 @@ private:
     Direction direction;
     char symbol;
     GameElement* heldItem;  // Non-owning pointer
+    int heldItemRoom;       // Where heldItem is numbered (Room::getElementIndex), -1 if none
+    int heldItemIndex;
+    bool reachedEnd;        // Went through the final room's door
+    int roomIndex;          // Room the player is in, every player has its own
     
     // Spring acceleration state
     Direction springDirection;
@@ -31,13 +35,26 @@ public:
     
     bool hasItem() const { return heldItem != nullptr; }
     GameElement* getHeldItem() const { return heldItem; }
-    void pickUpItem(GameElement* item) { heldItem = item; }
+    int getHeldItemRoom() const { return heldItemRoom; }
+    int getHeldItemIndex() const { return heldItemIndex; }
+    void pickUpItem(GameElement* item, int room, int index) {
+        heldItem = item;
+        heldItemRoom = item ? room : -1;
+        heldItemIndex = item ? index : -1;
+    }
     GameElement* disposeItem();
     
+    int getRoomIndex() const { return roomIndex; }
+    void setRoomIndex(int index) { roomIndex = index; }
+    
+    bool hasReachedEnd() const { return reachedEnd; }
+    void setReachedEnd(bool reached) { reachedEnd = reached; }
+    
     // Spring acceleration methods
     bool isUnderSpringEffect() const { return springCyclesRemaining > 0; }
     Direction getSpringDirection() const { return springDirection; }
     int getSpringVelocity() const { return springVelocity; }
+    int getSpringCyclesRemaining() const { return springCyclesRemaining; }
     void setSpringEffect(Direction dir, int velocity, int cycles) {
         springDirection = dir;
         springVelocity = velocity;
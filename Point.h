@@ -5,22 +5,22 @@ private:
     int x, y;
     
 public:
-    Point(int x = 0, int y = 0) : x(x), y(y) {}
+    constexpr Point(int x = 0, int y = 0) : x(x), y(y) {}
     
-    int getX() const { return x; }
-    int getY() const { return y; }
+    constexpr int getX() const { return x; }
+    constexpr int getY() const { return y; }
     void setX(int newX) { x = newX; }
     void setY(int newY) { y = newY; }
     
-    bool operator==(const Point& other) const {
+    constexpr bool operator==(const Point& other) const {
         return x == other.x && y == other.y;
     }
     
-    bool operator!=(const Point& other) const {
+    constexpr bool operator!=(const Point& other) const {
         return !(*this == other);
     }
     
-    Point operator+(const Point& other) const {
+    constexpr Point operator+(const Point& other) const {
         return Point(x + other.x, y + other.y);
     }
 };
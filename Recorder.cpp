@@ -0,0 +1,152 @@
+#include "Recorder.h"
+#include "AllocTracker.h"
+#include "SessionProtocol.h"
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+Recorder::Recorder(const std::string& name)
+    : baseName(name), ring(RECORDING_RING_SIZE), scratchUnsent(false), dropped(0), running(true) {
+    writer = std::thread(&Recorder::writerLoop, this);
+}
+
+Recorder::~Recorder() {
+    // The final frame must make it, the writer is emptying the ring
+    while (scratchUnsent && !ring.tryPush(scratch)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    running.store(false);
+    writer.join();
+}
+
+void Recorder::capture(const FrameBuffer& frame) {
+    scratch.at = getMicroseconds();
+    std::memcpy(scratch.cells, frame.getCells(), sizeof(scratch.cells));
+    scratchUnsent = !ring.tryPush(scratch);
+    if (scratchUnsent) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Appends text as the inside of a JSON string
+static void appendJsonText(std::string& out, const char* text, int length) {
+    static const char HEX[] = "0123456789abcdef";
+    for (int i = 0; i < length; i++) {
+        unsigned char ch = (unsigned char)text[i];
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += (char)ch;
+        } else if (ch < 0x20 || ch >= 0x7F) {
+            out += "\\u00";
+            out += HEX[ch >> 4];
+            out += HEX[ch & 15];
+        } else {
+            out += (char)ch;
+        }
+    }
+}
+
+void Recorder::writerLoop() {
+    AllocTracker::setSubsystem(AllocSubsystem::RECORDER);
+    const int width = SCREEN_WIDTH;
+    const int height = SCREEN_HEIGHT + SCREEN_OFFSET_Y;
+    
+    std::ofstream cast;
+    std::ofstream rec;
+    std::vector<RecordedFrame> batch(RECORDING_RING_SIZE);
+    std::vector<char> blank(width * height, ' ');
+    std::vector<char> shown(blank);  // Last frame written
+    std::vector<char> message;
+    std::vector<FrameRun> runs;
+    std::string output;
+    std::vector<uint32_t> index;  // Keyframe time and offset pairs
+    
+    bool started = false;
+    uint32_t lastAt = 0;
+    uint64_t elapsedMicros = 0;   // Frame times wrap, their differences don't
+    int sinceKeyframe = 0;
+    
+    while (true) {
+        // Read the flag first, so nothing captured before the game stopped is left behind
+        bool stopping = !running.load();
+        int count = ring.popBatch(batch.data(), (int)batch.size());
+        
+        for (int i = 0; i < count; i++) {
+            const RecordedFrame& frame = batch[i];
+            if (!started) {
+                cast.open(baseName + ".cast", std::ios::binary | std::ios::trunc);
+                cast << "{\"version\": 2, \"width\": " << width << ", \"height\": " << height
+                     << ", \"timestamp\": " << (long long)std::time(nullptr)
+                     << ", \"idle_time_limit\": 2, \"title\": \"Text Adventure\"}\n";
+                
+                rec.open(baseName + ".rec", std::ios::binary | std::ios::trunc);
+                uint32_t version = RecordingFormat::VERSION;
+                uint16_t size[2] = { (uint16_t)width, (uint16_t)height };
+                rec.write("TAGR", 4);
+                rec.write((const char*)&version, sizeof(version));
+                rec.write((const char*)size, sizeof(size));
+            } else {
+                elapsedMicros += frame.at - lastAt;
+            }
+            lastAt = frame.at;
+            
+            message.clear();
+            appendFrameDelta(shown.data(), frame.cells, width, height, message);
+            if (message.empty() && started) continue;  // Nothing changed
+            uint32_t millis = (uint32_t)(elapsedMicros / 1000);
+            
+            // asciicast: move the cursor to each changed run and print it
+            output.clear();
+            if (!started) output += "\x1b[?25l\x1b[2J";
+            if (!message.empty()) {
+                applyFrameDelta(message.data() + SessionMessage::HEADER_SIZE,
+                                message.size() - SessionMessage::HEADER_SIZE,
+                                shown.data(), width, height, runs);
+                for (const FrameRun& run : runs) {
+                    output += "\x1b[" + std::to_string(run.row + 1) + ";" + std::to_string(run.column + 1) + "H";
+                    output.append(shown.data() + run.row * width + run.column, run.length);
+                }
+            }
+            std::string line = "[" + std::to_string(elapsedMicros / 1000000) + ".";
+            std::string fraction = std::to_string(elapsedMicros % 1000000);
+            line += std::string(6 - fraction.size(), '0') + fraction + ", \"o\", \"";
+            appendJsonText(line, output.data(), (int)output.size());
+            line += "\"]\n";
+            cast << line;
+            
+            // Native: a full frame every RECORDING_KEYFRAME_INTERVAL records
+            if (!started || ++sinceKeyframe >= RECORDING_KEYFRAME_INTERVAL) {
+                message.clear();
+                appendFrameDelta(blank.data(), shown.data(), width, height, message);
+                if (message.empty()) {
+                    message.assign(SessionMessage::HEADER_SIZE, 0);  // Blank screen
+                }
+                message[2] = RecordingFormat::KEYFRAME;
+                index.push_back(millis);
+                index.push_back((uint32_t)rec.tellp());
+                sinceKeyframe = 0;
+            } else {
+                message[2] = RecordingFormat::DELTA;
+            }
+            rec.write((const char*)&millis, sizeof(millis));
+            rec.write(message.data(), (std::streamsize)message.size());
+            started = true;
+        }
+        
+        if (count > 0) {
+            cast.flush();
+            rec.flush();
+            continue;  // There may be more
+        }
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(RECORDING_FLUSH_MILLIS));
+    }
+    
+    if (started) {
+        uint32_t keyframes = (uint32_t)(index.size() / 2);
+        rec.write((const char*)index.data(), (std::streamsize)index.size() * sizeof(uint32_t));
+        rec.write((const char*)&keyframes, sizeof(keyframes));
+        rec.write("TAGI", 4);
+    }
+}
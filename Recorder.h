@@ -0,0 +1,63 @@
+#pragma once
+#include "GameConfig.h"
+#include "FrameBuffer.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Native recording (.rec), read back by RecordingReader:
+//   "TAGR", format version (uint32), width and height (uint16 each)
+//   records: time in milliseconds since the first frame (uint32), then a
+//            frame message as in SessionProtocol.h, typed KEYFRAME (runs
+//            drawn over a blank screen) or DELTA (runs drawn over the
+//            previous frame). Frames equal to the previous one are left out.
+//   index, written when the recording ends: per keyframe its time and file
+//            offset (uint32 each), then the keyframe count (uint32), "TAGI"
+// Everything little-endian. A recording cut off before its index is still
+// readable, the reader then finds the keyframes itself.
+namespace RecordingFormat {
+    const int VERSION = 1;
+    const int HEADER_SIZE = 12;
+    const char KEYFRAME = 'K';
+    const char DELTA = 'D';
+}
+
+// Copy of a presented frame with the time the game handed it over
+struct RecordedFrame {
+    uint32_t at;  // getMicroseconds()
+    char cells[SCREEN_WIDTH * (SCREEN_HEIGHT + SCREEN_OFFSET_Y)];
+};
+
+// Records the frames of the running game. capture() only copies the frame
+// into a fixed ring. A writer thread diffs it against the previous frame and
+// appends the changed cells to both files (opened with the first frame).
+// Frames that don't fit in the ring are dropped, the next one written
+// carries their changes (the last one is always written). Memory stays the same however long it records
+// (only the .rec index grows, by 8 bytes per keyframe).
+class Recorder {
+private:
+    std::string baseName;
+    SpscRing<RecordedFrame> ring;
+    RecordedFrame scratch;  // Game thread only
+    bool scratchUnsent;     // The ring was full, the newest frame is only in scratch
+    std::atomic<uint32_t> dropped;
+    std::atomic<bool> running;
+    std::thread writer;
+
+    void writerLoop();
+
+public:
+    explicit Recorder(const std::string& name);  // Writes <name>.cast and <name>.rec
+    ~Recorder();  // Writes what's left in the ring and the .rec index
+
+    // Prevent copying (owns the writer thread)
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Game thread only, never blocks
+    void capture(const FrameBuffer& frame);
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
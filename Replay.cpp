@@ -0,0 +1,162 @@
+#include "Replay.h"
+#include "Recorder.h"
+#include "FrameBuffer.h"
+#include "GameConfig.h"
+#include <conio.h>
+#include <iostream>
+#include <cstring>
+
+RecordingReader::RecordingReader() : width(0), height(0), dataEnd(0), time(0) {}
+
+bool RecordingReader::open(const std::string& filename) {
+    file.open(filename, std::ios::binary);
+    if (!file) return false;
+    
+    char magic[4];
+    uint32_t version = 0;
+    uint16_t size[2] = { 0, 0 };
+    file.read(magic, 4);
+    file.read((char*)&version, sizeof(version));
+    file.read((char*)size, sizeof(size));
+    if (!file || std::memcmp(magic, "TAGR", 4) != 0 || version != (uint32_t)RecordingFormat::VERSION) {
+        return false;
+    }
+    width = size[0];
+    height = size[1];
+    cells.assign(width * height, ' ');
+    
+    // Index at the end: entries, count, "TAGI"
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    dataEnd = fileSize;
+    if (fileSize >= RecordingFormat::HEADER_SIZE + 8) {
+        uint32_t count = 0;
+        file.seekg(fileSize - 8);
+        file.read((char*)&count, sizeof(count));
+        file.read(magic, 4);
+        std::streamoff indexStart = fileSize - 8 - (std::streamoff)count * sizeof(Keyframe);
+        if (file && std::memcmp(magic, "TAGI", 4) == 0 && indexStart >= RecordingFormat::HEADER_SIZE) {
+            keyframes.resize(count);
+            file.seekg(indexStart);
+            file.read((char*)keyframes.data(), (std::streamsize)count * sizeof(Keyframe));
+            dataEnd = indexStart;
+        }
+    }
+    file.clear();
+    if (keyframes.empty()) findKeyframes();
+    
+    return seek(0);
+}
+
+bool RecordingReader::readRecord(uint32_t& millis) {
+    if (file.tellg() >= dataEnd) return false;
+    
+    message.resize(SessionMessage::HEADER_SIZE);
+    file.read((char*)&millis, sizeof(millis));
+    file.read(message.data(), SessionMessage::HEADER_SIZE);
+    if (!file) return false;
+    
+    size_t payloadSize = (unsigned char)message[0] | ((size_t)(unsigned char)message[1] << 8);
+    message.resize(SessionMessage::HEADER_SIZE + payloadSize);
+    file.read(message.data() + SessionMessage::HEADER_SIZE, (std::streamsize)payloadSize);
+    return (bool)file;  // A record cut off mid-way ends the recording
+}
+
+void RecordingReader::findKeyframes() {
+    file.seekg(RecordingFormat::HEADER_SIZE);
+    while (true) {
+        std::streamoff offset = file.tellg();
+        uint32_t millis;
+        if (!readRecord(millis)) break;
+        if (message[2] == RecordingFormat::KEYFRAME) {
+            keyframes.push_back({ millis, (uint32_t)offset });
+        }
+    }
+    file.clear();
+}
+
+bool RecordingReader::seek(uint32_t millis) {
+    if (keyframes.empty()) return false;
+    
+    // Last keyframe at or before millis
+    size_t k = 0;
+    while (k + 1 < keyframes.size() && keyframes[k + 1].millis <= millis) {
+        k++;
+    }
+    file.clear();
+    file.seekg(keyframes[k].offset);
+    std::fill(cells.begin(), cells.end(), ' ');
+    if (!next()) return false;
+    
+    // Deltas up to millis
+    while (true) {
+        std::streamoff offset = file.tellg();
+        uint32_t nextMillis;
+        if (!readRecord(nextMillis) || nextMillis > millis) {
+            file.clear();
+            file.seekg(offset);
+            break;
+        }
+        applyFrameDelta(message.data() + SessionMessage::HEADER_SIZE, message.size() - SessionMessage::HEADER_SIZE,
+                        cells.data(), width, height, runs);
+        time = nextMillis;
+    }
+    return true;
+}
+
+bool RecordingReader::next() {
+    uint32_t millis;
+    if (!readRecord(millis)) return false;
+    
+    if (message[2] == RecordingFormat::KEYFRAME) {
+        std::fill(cells.begin(), cells.end(), ' ');
+    }
+    if (!applyFrameDelta(message.data() + SessionMessage::HEADER_SIZE, message.size() - SessionMessage::HEADER_SIZE,
+                         cells.data(), width, height, runs)) {
+        return false;
+    }
+    if (message[2] == RecordingFormat::KEYFRAME) {
+        // Whole screen, the runs only cover what isn't blank
+        runs.clear();
+        for (int row = 0; row < height; row++) {
+            runs.push_back({ row, 0, width });
+        }
+    }
+    time = millis;
+    return true;
+}
+
+int runReplay(const std::string& filename, int startSeconds) {
+    RecordingReader reader;
+    if (!reader.open(filename)) {
+        std::cerr << "Error: can't read recording " << filename << std::endl;
+        return 1;
+    }
+    reader.seek((uint32_t)startSeconds * 1000);
+    
+    hideCursor();
+    clearScreen();
+    FrameBuffer::presentCells(reader.getCells(), reader.getWidth(), reader.getHeight());
+    
+    // Frames are shown at their recorded time, relative to where playing started
+    uint32_t startTime = reader.getTime();
+    DWORD startTick = GetTickCount();
+    while (reader.next()) {
+        while ((int)(GetTickCount() - startTick) < (int)(reader.getTime() - startTime)) {
+            if (_kbhit() && _getch() == Keys::ESC) {
+                showCursor();
+                return 0;
+            }
+            Sleep(10);
+        }
+        
+        const char* cells = reader.getCells();
+        for (const FrameRun& run : reader.getChangedRuns()) {
+            gotoxy(run.column, run.row);
+            std::cout.write(cells + run.row * reader.getWidth() + run.column, run.length);
+        }
+        std::cout.flush();
+    }
+    showCursor();
+    return 0;
+}
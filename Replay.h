@@ -0,0 +1,49 @@
+#pragma once
+#include "SessionProtocol.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Reads a .rec recording (format in Recorder.h) frame by frame, and jumps to
+// any time through the keyframe index
+class RecordingReader {
+private:
+    struct Keyframe {
+        uint32_t millis;
+        uint32_t offset;
+    };
+    
+    std::ifstream file;
+    int width;
+    int height;
+    std::streamoff dataEnd;  // Where the records stop (the index starts)
+    std::vector<Keyframe> keyframes;
+    std::vector<char> cells;
+    std::vector<char> message;
+    std::vector<FrameRun> runs;
+    uint32_t time;
+    
+    bool readRecord(uint32_t& millis);  // Into message, false at the end
+    void findKeyframes();               // For recordings cut off before their index
+    
+public:
+    RecordingReader();
+    
+    bool open(const std::string& filename);
+    
+    // Frame shown at millis (the first one if earlier), read from the last keyframe before it
+    bool seek(uint32_t millis);
+    // Next frame, false at the end of the recording
+    bool next();
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint32_t getTime() const { return time; }
+    const char* getCells() const { return cells.data(); }
+    const std::vector<FrameRun>& getChangedRuns() const { return runs; }  // By the last next()
+};
+
+// Plays a recording in the console from startSeconds on, ESC stops.
+// Returns the process exit code.
+int runReplay(const std::string& filename, int startSeconds);
@@ -0,0 +1,130 @@
+#include "RewindBuffer.h"
+#include "AllocTracker.h"
+
+RewindBuffer::RewindBuffer(int capacity, int interval)
+    : frames(capacity), keyframes(capacity / interval + 2), keyframeInterval(interval),
+      first(0), count(0), sinceKeyframe(0) {
+    for (Frame& frame : frames) {
+        frame.keyframe = -1;
+        frame.size = 0;
+        frame.changes.reserve(REWIND_DELTA_CAPACITY);
+    }
+    for (int i = (int)keyframes.size() - 1; i >= 0; i--) {
+        freeKeyframes.push_back(i);
+    }
+}
+
+void RewindBuffer::clear() {
+    for (Frame& frame : frames) {
+        releaseFrame(frame);
+    }
+    first = 0;
+    count = 0;
+    sinceKeyframe = 0;
+}
+
+// Every keyframe buffer grows at once, not one per keyframe later on
+void RewindBuffer::reserve(size_t stateSize) {
+    if (stateSize <= latest.capacity()) return;
+    
+    AllocTracker::restartWarmup();
+    latest.reserve(stateSize);
+    for (StateVector& buffer : keyframes) {
+        buffer.reserve(stateSize);
+    }
+}
+
+int RewindBuffer::takeKeyframe() {
+    if (freeKeyframes.empty()) {
+        keyframes.emplace_back();
+        keyframes.back().reserve(latest.capacity());
+        freeKeyframes.reserve(keyframes.size());  // Releasing never allocates
+        return (int)keyframes.size() - 1;
+    }
+    int buffer = freeKeyframes.back();
+    freeKeyframes.pop_back();
+    return buffer;
+}
+
+void RewindBuffer::releaseFrame(Frame& frame) {
+    if (frame.keyframe >= 0) {
+        freeKeyframes.push_back(frame.keyframe);
+        frame.keyframe = -1;
+    }
+}
+
+// The oldest frame must stay a keyframe, the deltas after it are useless without one
+void RewindBuffer::dropOldest() {
+    do {
+        releaseFrame(frameAt(0));
+        first = (first + 1) % frames.size();
+        count--;
+    } while (count > 0 && frameAt(0).keyframe < 0);
+}
+
+void RewindBuffer::record(const StateVector& state) {
+    if (frames.empty()) return;  // Capacity 0 keeps nothing
+    
+    if (count == (int)frames.size()) {
+        dropOldest();
+    }
+    
+    reserve(state.size());
+    
+    Frame& frame = frameAt(count);
+    bool isKeyframe = count == 0 || sinceKeyframe >= keyframeInterval;
+    frame.size = (int)state.size();
+    frame.changes.clear();
+    for (int i = 0; i < (int)state.size() && !isKeyframe; i++) {
+        if (i >= (int)latest.size() || state[i] != latest[i]) {
+            if (frame.changes.size() + 2 > frame.changes.capacity()) {
+                isKeyframe = true;
+                break;
+            }
+            frame.changes.push_back(i);
+            frame.changes.push_back(state[i]);
+        }
+    }
+    if (isKeyframe) {
+        frame.changes.clear();
+        frame.keyframe = takeKeyframe();
+        keyframes[frame.keyframe].assign(state.begin(), state.end());  // Reuses the buffer
+        sinceKeyframe = 0;
+    }
+    
+    latest.assign(state.begin(), state.end());
+    sinceKeyframe++;
+    count++;
+}
+
+bool RewindBuffer::rewind(int ticks, StateVector& state) {
+    if (count == 0) return false;
+    
+    int target = count - 1 - ticks;
+    if (target < 0) target = 0;
+    
+    int keyframe = target;
+    while (frameAt(keyframe).keyframe < 0) {
+        keyframe--;
+    }
+    
+    const StateVector& values = keyframes[frameAt(keyframe).keyframe];
+    state.assign(values.begin(), values.end());
+    for (int age = keyframe + 1; age <= target; age++) {
+        const Frame& frame = frameAt(age);
+        const std::vector<int>& changes = frame.changes;
+        state.resize(frame.size);
+        for (int i = 0; i + 1 < (int)changes.size(); i += 2) {
+            state[changes[i]] = changes[i + 1];
+        }
+    }
+    
+    // Continue recording from the target
+    for (int age = target + 1; age < count; age++) {
+        releaseFrame(frameAt(age));
+    }
+    count = target + 1;
+    sinceKeyframe = target - keyframe + 1;
+    latest.assign(state.begin(), state.end());
+    return true;
+}
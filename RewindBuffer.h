@@ -0,0 +1,52 @@
+#pragma once
+#include "SaveFile.h"
+#include <vector>
+
+// The last few hundred ticks of game state, for rewinding.
+// Every tick is stored as the list of state values that changed since the
+// tick before (index, new value) plus the new state size, values past the old
+// size count as changed; every keyframeInterval ticks the full state is stored
+// instead. Going back means starting at the keyframe before the target tick and
+// applying the deltas up to it, so no more than keyframeInterval deltas are
+// ever replayed.
+// Frames live in a fixed ring whose delta buffers are reserved up front, and
+// keyframe states go to a pool of buffers sized by reserve() (or whenever the
+// state outgrows them), so recording a tick doesn't allocate once the game has
+// warmed up.
+// A delta too big for its buffer is stored as a keyframe instead (a chunk
+// load); the pool only grows when more keyframes are alive than it holds.
+class RewindBuffer {
+private:
+    struct Frame {
+        int keyframe;             // Buffer in keyframes holding the whole state, -1 for a delta
+        int size;                 // State size after this frame
+        std::vector<int> changes; // Delta: index, value, index, value, ...
+    };
+
+    std::vector<Frame> frames;
+    std::vector<StateVector> keyframes;
+    std::vector<int> freeKeyframes;
+    int keyframeInterval;
+    int first;   // Oldest frame, always a keyframe
+    int count;
+    int sinceKeyframe;
+    StateVector latest;  // State of the newest frame
+
+    Frame& frameAt(int age) { return frames[(first + age) % frames.size()]; }
+    void dropOldest();
+    int takeKeyframe();
+    void releaseFrame(Frame& frame);
+
+public:
+    RewindBuffer(int capacity, int interval);  // Capacity 0 records nothing
+
+    void clear();
+    void reserve(size_t stateSize);  // Every buffer takes states up to this size from now on
+    void record(const StateVector& state);
+
+    // State from ticks frames ago (clamped to the oldest frame). Everything newer
+    // is dropped, the game continues from there. False if nothing was recorded.
+    bool rewind(int ticks, StateVector& state);
+
+    int getSize() const { return count; }
+};
@@ -1,11 +1,41 @@
 #include "Room.h"
 #include "GameConfig.h"
+#include "AllocTracker.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 
-Room::Room(int id, bool finalRoom)
-    : roomId(id), isFinalRoom(finalRoom) {}
+namespace {
+    // Drops the elements in sorted from a quick-access list
+    template <typename T>
+    void removeElements(std::vector<T*>& list, const std::vector<GameElement*>& sorted) {
+        list.erase(std::remove_if(list.begin(), list.end(), [&sorted](T* element) {
+            return std::binary_search(sorted.begin(), sorted.end(), (GameElement*)element);
+        }), list.end());
+    }
+}
+
+Room::Room(int id, bool finalRoom, int roomWidth, int roomHeight)
+    : roomId(id), isFinalRoom(finalRoom), width(roomWidth), height(roomHeight),
+      cellElements(roomWidth, roomHeight, nullptr),
+      springCells(roomWidth, roomHeight, SpringCell{ nullptr, -1 }),
+      triggers(this), layoutVersion(0), ownFlowField(std::make_unique<DistanceField>()),
+      flowField(ownFlowField.get()), layout(nullptr),
+      blastVisited(roomWidth, roomHeight), switchesPreCounted(false) {}
+
+// Sparse grids and blast bits: the few elements left per room decide the memory
+Room::Room(int id, bool finalRoom, const RoomLayout* sharedLayout, DistanceField* sharedFlowField)
+    : roomId(id), isFinalRoom(finalRoom), width(SCREEN_WIDTH), height(SCREEN_HEIGHT),
+      cellElements(SCREEN_WIDTH, SCREEN_HEIGHT, nullptr, true),
+      springCells(SCREEN_WIDTH, SCREEN_HEIGHT, SpringCell{ nullptr, -1 }, true),
+      triggers(this), layoutVersion(0), flowField(sharedFlowField), layout(sharedLayout),
+      wallsGone(sharedLayout->getWallCount(), false),
+      blastVisited(SCREEN_WIDTH, SCREEN_HEIGHT, true), switchesPreCounted(false) {}
+
+bool Room::isInside(Point pos) const {
+    return cellElements.isInside(pos);
+}
 
 void Room::addElement(std::unique_ptr<GameElement> element) {
     // Store raw pointer BEFORE moving ownership
@@ -14,8 +44,20 @@ void Room::addElement(std::unique_ptr<GameElement> element) {
     // Move ownership to elements vector
     elements.push_back(std::move(element));
     
+    Point pos = rawPtr->getPosition();
+    if (isInside(pos) && !getElementAt(pos)) {
+        cellElements.set(pos, rawPtr);
+    }
+    
+    if (isStatic(rawPtr)) {
+        layoutVersion++;
+    }
+    
     // Now store non-owning pointers in quick-access lists
-    if (Door* door = dynamic_cast<Door*>(rawPtr)) {
+    
+    if (Key* key = dynamic_cast<Key*>(rawPtr)) {
+        keys.push_back(key);
+    } else if (Door* door = dynamic_cast<Door*>(rawPtr)) {
         doors.push_back(door);
     } else if (Bomb* bomb = dynamic_cast<Bomb*>(rawPtr)) {
         bombs.push_back(bomb);
@@ -25,34 +67,158 @@ void Room::addElement(std::unique_ptr<GameElement> element) {
         riddles.push_back(riddle);
     } else if (Switch* sw = dynamic_cast<Switch*>(rawPtr)) {
         switches.push_back(sw);
+        sw->setTriggerGraph(&triggers);
+        if (!switchesPreCounted) {
+            triggers.addSwitch(sw->getGroupId(), sw->getIsOn());
+        }
     } else if (Spring* spring = dynamic_cast<Spring*>(rawPtr)) {
         springs.push_back(spring);
+        setSpringCells(spring, spring);
+    } else if (Enemy* enemy = dynamic_cast<Enemy*>(rawPtr)) {
+        enemies.push_back(enemy);
     }
 }
 
-GameElement* Room::getElementAt(Point pos) const {
-    for (const auto& elem : elements) {
-        if (elem && elem->getPosition() == pos) {
-            // Check if element is on-screen (not collected)
-            Point elemPos = elem->getPosition();
-            if (elemPos.getX() >= 0 && elemPos.getX() < SCREEN_WIDTH &&
-                elemPos.getY() >= 0 && elemPos.getY() < SCREEN_HEIGHT) {
-                return elem.get();
+// Creates the element a screen char stands for (springs are merged by the loader).
+// Returns false for floor and unknown chars.
+bool Room::addElementFromChar(char ch, Point pos, const TriggerWiring& wiring) {
+    LevelRecord record{ getElementKind(ch), pos, -1, 0, Direction::NONE };
+    switch (record.kind) {
+        case ElementKind::SWITCH:
+            record.group = wiring.getSwitchGroup(pos);
+            break;
+        case ElementKind::DOOR:
+            record.value = ch - '0';  // Target room
+            record.group = wiring.getDoorGroup(record.value);
+            break;
+        case ElementKind::SPRING:
+            return false;  // Needs its neighbors, see makeSpringRun
+        default:
+            break;
+    }
+    return addElementFromRecord(record);
+}
+
+bool Room::addElementFromRecord(const LevelRecord& record) {
+    Point pos = record.pos;
+    switch (record.kind) {
+        case ElementKind::WALL:
+            if (!layout) {
+                addElement(std::make_unique<Wall>(pos));
             }
+            return true;
+        
+        case ElementKind::KEY:
+            addElement(std::make_unique<Key>(pos));
+            return true;
+        
+        case ElementKind::TORCH:
+            addElement(std::make_unique<Torch>(pos));
+            return true;
+        
+        case ElementKind::BOMB:
+            addElement(std::make_unique<Bomb>(pos));
+            return true;
+        
+        case ElementKind::OBSTACLE:
+            addElement(std::make_unique<Obstacle>(pos));
+            return true;
+        
+        case ElementKind::RIDDLE:
+            addElement(std::make_unique<Riddle>(pos));
+            return true;
+        
+        case ElementKind::SWITCH:
+            addElement(std::make_unique<Switch>(pos, record.group));
+            return true;
+        
+        case ElementKind::SPRING:
+            addElement(std::make_unique<Spring>(pos, record.dir, record.value));
+            return true;
+        
+        case ElementKind::ENEMY:
+            addElement(std::make_unique<Enemy>(pos));
+            return true;
+        
+        case ElementKind::DOOR:
+            addElement(std::make_unique<Door>(pos, roomId, record.value, record.group));
+            return true;
+        
+        default:
+            return false;  // Floor, legend marker or unknown
+    }
+}
+
+bool Room::isStatic(const GameElement* element) {
+    return dynamic_cast<const Wall*>(element) || dynamic_cast<const Obstacle*>(element);
+}
+
+// A spring is indexed at its first cell only, springCells has the rest of its body
+GameElement* Room::getElementAt(Point pos) const {
+    GameElement* element = cellElements.get(pos);
+    if (!element) {
+        element = springCells.get(pos).spring;
+    }
+    if (!element && layout) {
+        int wall = layout->findWall(pos);
+        if (wall >= 0 && !wallsGone[wall]) {
+            element = layout->getWall(wall);
         }
     }
-    return nullptr;
+    return element;
+}
+
+bool Room::placeElement(GameElement* element, Point pos) {
+    if (!isInside(pos) || getElementAt(pos)) {
+        return false;  // One element per cell
+    }
+    cellElements.set(pos, element);
+    element->setPosition(pos);
+    return true;
+}
+
+void Room::moveElement(GameElement* element, Point newPos) {
+    if (isStatic(element)) {
+        layoutVersion++;  // Cached views and paths are out of date
+    }
+    
+    Point oldPos = element->getPosition();
+    if (cellElements.get(oldPos) == element) {
+        cellElements.set(oldPos, nullptr);
+    }
+    if (!placeElement(element, newPos)) {
+        element->setPosition(newPos);  // Off-screen or shared cell, not indexed
+    }
 }
 
 // NEW METHOD - instead of actually removing, we just hide collected items
 void Room::markElementAsCollected(GameElement* element) {
+    // A shared wall stays where it is, only this room stops seeing it
+    int wall = layout ? layout->getWallIndex(element) : -1;
+    if (wall >= 0) {
+        wallsGone[wall] = true;
+        layoutVersion++;
+        return;
+    }
+    
+    // A destroyed spring leaves the spring map
+    if (Spring* spring = dynamic_cast<Spring*>(element)) {
+        setSpringCells(spring, nullptr);
+    }
+    
+    // A destroyed switch leaves its group
+    if (Switch* sw = dynamic_cast<Switch*>(element)) {
+        if (getSwitchAt(sw->getPosition()) == sw) {
+            triggers.removeSwitch(sw->getGroupId(), sw->getIsOn());
+        }
+    }
+    
     // Move element off-screen instead of deleting
-    element->setPosition(Point(-100, -100));
+    moveElement(element, Point(-100, -100));
 }
 
 bool Room::isPositionWalkable(Point pos) const {
-    if (pos.getX() < 0 || pos.getX() >= SCREEN_WIDTH ||
-        pos.getY() < 0 || pos.getY() >= SCREEN_HEIGHT) {
+    if (!isInside(pos)) {
         return false;
     }
     
@@ -69,96 +235,74 @@ bool Room::isWall(Point pos) const {
     return dynamic_cast<Wall*>(elem) != nullptr;
 }
 
+bool Room::blocksSight(Point pos) const {
+    if (!isInside(pos)) return true;
+    GameElement* elem = getElementAt(pos);
+    return elem && isStatic(elem);
+}
+
 Door* Room::getDoorAt(Point pos) const {
-    for (Door* door : doors) {
-        if (door && door->getPosition() == pos) {
-            // Check if door is on-screen (not collected/destroyed)
-            Point doorPos = door->getPosition();
-            if (doorPos.getX() >= 0 && doorPos.getX() < SCREEN_WIDTH &&
-                doorPos.getY() >= 0 && doorPos.getY() < SCREEN_HEIGHT) {
-                return door;
-            }
-        }
-    }
-    return nullptr;
+    return dynamic_cast<Door*>(getElementAt(pos));
 }
 
 Obstacle* Room::getObstacleAt(Point pos) const {
-    for (Obstacle* obs : obstacles) {
-        if (obs && obs->getPosition() == pos) {
-            // Check if obstacle is on-screen (not collected/destroyed)
-            Point obsPos = obs->getPosition();
-            if (obsPos.getX() >= 0 && obsPos.getX() < SCREEN_WIDTH &&
-                obsPos.getY() >= 0 && obsPos.getY() < SCREEN_HEIGHT) {
-                return obs;
-            }
-        }
-    }
-    return nullptr;
+    return dynamic_cast<Obstacle*>(getElementAt(pos));
 }
 
 Riddle* Room::getRiddleAt(Point pos) const {
-    for (Riddle* riddle : riddles) {
-        if (riddle && riddle->getPosition() == pos) {
-            // Check if riddle is on-screen (not solved)
-            Point riddlePos = riddle->getPosition();
-            if (riddlePos.getX() >= 0 && riddlePos.getX() < SCREEN_WIDTH &&
-                riddlePos.getY() >= 0 && riddlePos.getY() < SCREEN_HEIGHT) {
-                return riddle;
-            }
-        }
-    }
-    return nullptr;
+    return dynamic_cast<Riddle*>(getElementAt(pos));
 }
 
 Switch* Room::getSwitchAt(Point pos) const {
-    for (Switch* sw : switches) {
-        if (sw && sw->getPosition() == pos) {
-            // Check if switch is on-screen (not destroyed)
-            Point switchPos = sw->getPosition();
-            if (switchPos.getX() >= 0 && switchPos.getX() < SCREEN_WIDTH &&
-                switchPos.getY() >= 0 && switchPos.getY() < SCREEN_HEIGHT) {
-                return sw;
-            }
-        }
-    }
-    return nullptr;
+    return dynamic_cast<Switch*>(getElementAt(pos));
 }
 
 bool Room::areSwitchesActivated(int groupId) const {
-    if (groupId < 0) return true;  // No switches required
-    
-    // Check if all switches in this group are ON
-    bool foundAny = false;
-    for (Switch* sw : switches) {
-        if (sw && sw->getGroupId() == groupId) {
-            foundAny = true;
-            Point switchPos = sw->getPosition();
-            // Only count switches that are still on-screen
-            if (switchPos.getX() >= 0 && switchPos.getX() < SCREEN_WIDTH &&
-                switchPos.getY() >= 0 && switchPos.getY() < SCREEN_HEIGHT) {
-                if (!sw->getIsOn()) {
-                    return false;  // Found an OFF switch
+    return triggers.isGroupActive(groupId);
+}
+
+void Room::addTrigger(int groupId, TriggerAction action) {
+    triggers.addAction(groupId, action);
+}
+
+void Room::runTriggerAction(const TriggerAction& action) {
+    GameElement* elem = getElementAt(action.target);
+    
+    switch (action.type) {
+        case TriggerAction::Type::OPEN_WALL:
+            if (dynamic_cast<Wall*>(elem)) {
+                markElementAsCollected(elem);
+            }
+            break;
+            
+        case TriggerAction::Type::ARM_BOMB:
+            if (Bomb* bomb = dynamic_cast<Bomb*>(elem)) {
+                if (!bomb->isActivated()) {
+                    bomb->activate();
                 }
             }
-        }
+            break;
     }
-    
-    return foundAny;  // All switches are ON (or no switches in group)
 }
 
-Spring* Room::getSpringAt(Point pos) const {
-    for (Spring* spring : springs) {
-        if (spring && spring->isPartOfSpring(pos)) {
-            // Check if spring is on-screen (not destroyed)
-            Point springPos = spring->getPosition();
-            if (springPos.getX() >= 0 && springPos.getX() < SCREEN_WIDTH &&
-                springPos.getY() >= 0 && springPos.getY() < SCREEN_HEIGHT) {
-                return spring;
-            }
+// Writes value (the spring itself, or nullptr to clear) into every cell the spring covers
+void Room::setSpringCells(Spring* spring, Spring* value) {
+    for (int i = 0; i < spring->getLength(); i++) {
+        Point cell = spring->getCellAt(i);
+        if (value) {
+            springCells.set(cell, SpringCell{ value, i });
+        } else if (springCells.get(cell).spring == spring) {
+            springCells.set(cell, SpringCell{ nullptr, -1 });
         }
     }
-    return nullptr;
+}
+
+Spring* Room::getSpringAt(Point pos) const {
+    return getSpringCellAt(pos).spring;
+}
+
+SpringCell Room::getSpringCellAt(Point pos) const {
+    return springCells.get(pos);
 }
 
 bool Room::tryPushObstacle(Obstacle* obs, Direction dir) {
@@ -177,92 +321,797 @@ bool Room::tryPushObstacle(Obstacle* obs, Direction dir) {
     }
     
     // Push the obstacle
-    obs->setPosition(newPos);
+    moveElement(obs, newPos);
     return true;
 }
 
-void Room::updateBombs() {
-    for (auto it = bombs.begin(); it != bombs.end(); ) {
-        if (*it && (*it)->isActivated() && (*it)->tick()) {
-            explodeBomb(*it);
-            // Remove from quick-access list only
-            it = bombs.erase(it);
+void Room::update(const std::vector<Point>& playerPositions, const std::vector<const GameElement*>& heldItems) {
+    if (!playerPositions.empty()) {
+        // The camera follows the middle of the room's players
+        int sumX = 0, sumY = 0;
+        for (const Point& pos : playerPositions) {
+            sumX += pos.getX();
+            sumY += pos.getY();
+        }
+        int count = (int)playerPositions.size();
+        camera.follow(Point(sumX / count, sumY / count), width, height);
+        
+        loadChunksAround(camera.getOrigin() + Point(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2),
+                         SCREEN_WIDTH / 2 + CHUNK_SIZE, SCREEN_HEIGHT / 2 + CHUNK_SIZE);
+        for (const Point& pos : playerPositions) {
+            loadChunksAround(pos, CHUNK_SIZE, CHUNK_SIZE);
+        }
+    }
+    unloadIdleChunks(playerPositions, heldItems);
+    
+    updateBombs();
+    updateEnemies(playerPositions);
+}
+
+// Large rooms read their chunks from the level file the first time they are needed
+void Room::setLevel(std::unique_ptr<ChunkedLevel> chunkedLevel) {
+    level = std::move(chunkedLevel);
+    int chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    loadedChunks.assign(chunksX * chunksY, false);
+    
+    // Switches far away still hold their doors shut, the level counted them up front
+    switchesPreCounted = true;
+    level->registerSwitches(triggers);
+    
+    // Trigger targets are loaded right away and stay, a group may fire from anywhere
+    for (const TriggerWiring::ActionEntry& entry : level->getWiring().actions) {
+        loadChunkAt(entry.action.target, true);
+        addTrigger(entry.group, entry.action);
+    }
+}
+
+int Room::getChunkIndex(Point pos) const {
+    return (pos.getY() / CHUNK_SIZE) * ((width + CHUNK_SIZE - 1) / CHUNK_SIZE) + pos.getX() / CHUNK_SIZE;
+}
+
+Point Room::getChunkOrigin(int chunk) const {
+    int chunksPerRow = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    return Point((chunk % chunksPerRow) * CHUNK_SIZE, (chunk / chunksPerRow) * CHUNK_SIZE);
+}
+
+int Room::findChunkSlot(int chunk) const {
+    for (int i = 0; i < (int)chunkSlots.size(); i++) {
+        if (chunkSlots[i].chunk == chunk) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Room::loadChunkAt(Point pos, bool pin) {
+    if (!level || !isInside(pos)) return;
+    
+    int chunk = getChunkIndex(pos);
+    if (!loadedChunks[chunk]) {
+        loadChunk(chunk);
+    }
+    if (pin) {
+        chunkSlots[findChunkSlot(chunk)].pinned = true;
+    }
+}
+
+void Room::loadChunk(int chunk) {
+    loadedChunks[chunk] = true;
+    AllocTracker::restartWarmup();  // The chunk's elements and grid cells are allocated now
+    
+    size_t first = elements.size();
+    Point origin = getChunkOrigin(chunk);
+    level->loadChunk(*this, origin.getX() / CHUNK_SIZE, origin.getY() / CHUNK_SIZE);
+    
+    chunkSlots.emplace_back();
+    LoadedChunk& slot = chunkSlots.back();
+    slot.chunk = chunk;
+    slot.pinned = false;
+    slot.idleTicks = 0;
+    StateWriter out(slot.pristine);
+    for (size_t i = first; i < elements.size(); i++) {
+        slot.elements.push_back(elements[i].get());
+        writeElement(out, elements[i].get());
+    }
+    
+    // A chunk that was changed comes back the way it was left
+    auto memory = unloadedChunks.find(chunk);
+    if (memory != unloadedChunks.end()) {
+        restoreElements(slot.elements, memory->second);
+    }
+}
+
+void Room::loadChunksAround(Point center, int rangeX, int rangeY) {
+    if (!level) return;
+    
+    for (int y = center.getY() - rangeY; y < center.getY() + rangeY + CHUNK_SIZE; y += CHUNK_SIZE) {
+        for (int x = center.getX() - rangeX; x < center.getX() + rangeX + CHUNK_SIZE; x += CHUNK_SIZE) {
+            Point pos(std::max(0, std::min(x, width - 1)), std::max(0, std::min(y, height - 1)));
+            loadChunkAt(pos);
+        }
+    }
+}
+
+// One chunk further than loadChunksAround reaches, so a chunk at the edge
+// isn't unloaded and loaded again while the camera moves back and forth
+bool Room::isChunkNear(int chunk, Point center, int rangeX, int rangeY) const {
+    Point origin = getChunkOrigin(chunk);
+    return origin.getX() + CHUNK_SIZE > center.getX() - rangeX - CHUNK_SIZE &&
+           origin.getX() < center.getX() + rangeX + 2 * CHUNK_SIZE &&
+           origin.getY() + CHUNK_SIZE > center.getY() - rangeY - CHUNK_SIZE &&
+           origin.getY() < center.getY() + rangeY + 2 * CHUNK_SIZE;
+}
+
+void Room::unloadIdleChunks(const std::vector<Point>& playerPositions, const std::vector<const GameElement*>& heldItems) {
+    if (!level) return;
+    
+    Point cameraCenter = camera.getOrigin() + Point(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    for (int i = (int)chunkSlots.size() - 1; i >= 0; i--) {
+        LoadedChunk& slot = chunkSlots[i];
+        bool near = slot.pinned;
+        if (!playerPositions.empty()) {
+            near = near || isChunkNear(slot.chunk, cameraCenter, SCREEN_WIDTH / 2 + CHUNK_SIZE, SCREEN_HEIGHT / 2 + CHUNK_SIZE);
+        }
+        for (const Point& pos : playerPositions) {
+            near = near || isChunkNear(slot.chunk, pos, CHUNK_SIZE, CHUNK_SIZE);
+        }
+        
+        if (near) {
+            slot.idleTicks = 0;
+        } else if (++slot.idleTicks >= CHUNK_UNLOAD_TICKS) {
+            if (canUnloadChunk(slot, heldItems)) {
+                unloadChunk(i, true);
+            } else {
+                slot.idleTicks = 0;  // Asked again in CHUNK_UNLOAD_TICKS
+            }
+        }
+    }
+}
+
+// A chunk only goes when its elements are all in it or collected and nothing
+// else stands on it: an element that left its chunk (pushed, walked off,
+// dropped in another room) or a carried one would be freed under its holder.
+// Ticking bombs keep their chunk too.
+bool Room::canUnloadChunk(const LoadedChunk& slot, const std::vector<const GameElement*>& heldItems) {
+    if (slot.pinned) return false;
+    
+    for (GameElement* element : slot.elements) {
+        Point pos = element->getPosition();
+        if (isInside(pos)) {
+            if (getChunkIndex(pos) != slot.chunk || getElementAt(pos) != element) return false;
+        } else if (pos != Point(-100, -100) ||
+                   std::find(heldItems.begin(), heldItems.end(), element) != heldItems.end()) {
+            return false;
+        }
+        
+        Bomb* bomb = dynamic_cast<Bomb*>(element);
+        if (bomb && bomb->isActivated() && !bomb->hasDetonated()) return false;
+    }
+    
+    chunkScratch.assign(slot.elements.begin(), slot.elements.end());
+    std::sort(chunkScratch.begin(), chunkScratch.end());
+    Point origin = getChunkOrigin(slot.chunk);
+    for (int y = origin.getY(); y < origin.getY() + CHUNK_SIZE; y++) {
+        for (int x = origin.getX(); x < origin.getX() + CHUNK_SIZE; x++) {
+            GameElement* element = cellElements.get(Point(x, y));
+            if (element && !std::binary_search(chunkScratch.begin(), chunkScratch.end(), element)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The switch group counts aren't touched: an unloaded switch still counts
+// the way it was left, like the ones that were never loaded.
+void Room::unloadChunk(int slotIndex, bool keepState) {
+    AllocTracker::restartWarmup();  // The chunk's state is stored
+    LoadedChunk& slot = chunkSlots[slotIndex];
+    
+    if (keepState) {
+        StateVector values;
+        StateWriter out(values);
+        for (GameElement* element : slot.elements) {
+            writeElement(out, element);
+        }
+        if (values == slot.pristine) {
+            unloadedChunks.erase(slot.chunk);
         } else {
-            ++it;
+            unloadedChunks[slot.chunk] = std::move(values);
+        }
+    }
+    
+    for (GameElement* element : slot.elements) {
+        if (Spring* spring = dynamic_cast<Spring*>(element)) {
+            setSpringCells(spring, nullptr);
         }
+        if (isStatic(element)) {
+            layoutVersion++;  // Cached views and paths are out of date
+        }
+        if (getElementAt(element->getPosition()) == element) {
+            cellElements.set(element->getPosition(), nullptr);
+        }
+    }
+    
+    chunkScratch.assign(slot.elements.begin(), slot.elements.end());
+    std::sort(chunkScratch.begin(), chunkScratch.end());
+    removeElements(keys, chunkScratch);
+    removeElements(doors, chunkScratch);
+    removeElements(bombs, chunkScratch);
+    removeElements(obstacles, chunkScratch);
+    removeElements(riddles, chunkScratch);
+    removeElements(switches, chunkScratch);
+    removeElements(springs, chunkScratch);
+    removeElements(enemies, chunkScratch);
+    elements.erase(std::remove_if(elements.begin(), elements.end(), [this](const std::unique_ptr<GameElement>& element) {
+        return std::binary_search(chunkScratch.begin(), chunkScratch.end(), element.get());
+    }), elements.end());
+    
+    // Springs run right and down, into the next chunks
+    int chunk = slot.chunk;
+    int chunksPerRow = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    loadedChunks[chunk] = false;
+    chunkSlots.erase(chunkSlots.begin() + slotIndex);
+    releaseGridChunk(chunk);
+    if (chunk % chunksPerRow + 1 < chunksPerRow && !loadedChunks[chunk + 1]) {
+        releaseGridChunk(chunk + 1);
+    }
+    if (chunk + chunksPerRow < (int)loadedChunks.size() && !loadedChunks[chunk + chunksPerRow]) {
+        releaseGridChunk(chunk + chunksPerRow);
     }
 }
 
-void Room::explodeBomb(Bomb* bomb) {
-    if (!bomb) return;
+void Room::releaseGridChunk(int chunk) {
+    Point origin = getChunkOrigin(chunk);
+    bool elementsLeft = false;
+    bool springsLeft = false;
+    for (int y = origin.getY(); y < origin.getY() + CHUNK_SIZE; y++) {
+        for (int x = origin.getX(); x < origin.getX() + CHUNK_SIZE; x++) {
+            elementsLeft = elementsLeft || cellElements.get(Point(x, y)) != nullptr;
+            springsLeft = springsLeft || getSpringAt(Point(x, y)) != nullptr;
+        }
+    }
     
-    Point bombPos = bomb->getPosition();
+    if (!elementsLeft) {
+        cellElements.releaseChunk(origin);
+    }
+    if (!springsLeft) {
+        springCells.releaseChunk(origin);
+    }
+    blastVisited.releaseChunk(origin);
+}
+
+void Room::updateBombs() {
+    pendingBlasts.clear();
+    for (Bomb* bomb : bombs) {
+        // Detonated bombs stay listed (a rewind may re-arm them) but never tick again
+        if (!bomb->hasDetonated() && bomb->isActivated() && bomb->tick()) {
+            pendingBlasts.push_back(PendingBlast{ bomb, bomb->getPosition() });
+            bomb->detonate();
+            markElementAsCollected(bomb);
+        }
+    }
+    
+    if (!pendingBlasts.empty()) {
+        runBlasts();
+    }
+}
+
+void Room::takeDetonations(std::vector<Point>& out) {
+    out.insert(out.end(), detonations.begin(), detonations.end());
+    detonations.clear();
+}
+
+// Processes pendingBlasts as a breadth-first work queue: bombs caught in a
+// blast are appended and go off in the next wave, all within this tick.
+// blastVisited makes sure every cell in range is destroyed at most once.
+void Room::runBlasts() {
+    blastVisited.clear();
     
-    // Remove bomb itself
-    markElementAsCollected(bomb);
+    for (size_t next = 0; next < pendingBlasts.size(); next++) {
+        Point center = pendingBlasts[next].center;
+        detonations.push_back(center);
+        
+        // Destroy everything within radius 3 except walls, which only break
+        // next to the blast (distance <= 1). Other bombs join the next wave.
+        for (int dy = -3; dy <= 3; dy++) {
+            for (int dx = -3; dx <= 3; dx++) {
+                Point checkPos(center.getX() + dx, center.getY() + dy);
+                if (blastVisited.test(checkPos)) continue;
+                
+                GameElement* elem = getElementAt(checkPos);
+                bool adjacent = std::abs(dx) <= 1 && std::abs(dy) <= 1;
+                if (elem && dynamic_cast<Wall*>(elem) && !adjacent) {
+                    continue;  // Not visited, a later blast may still be next to it
+                }
+                blastVisited.set(checkPos);
+                if (!elem) continue;
+                
+                if (Bomb* other = dynamic_cast<Bomb*>(elem)) {
+                    pendingBlasts.push_back(PendingBlast{ other, checkPos });
+                    other->detonate();
+                }
+                markElementAsCollected(elem);
+            }
+        }
+    }
+}
+
+// Every enemy steps to the neighbor closest to a player, using one flow field for all
+// Only enemies the camera sees are awake, the flow field covers just that window
+void Room::updateEnemies(const std::vector<Point>& playerPositions) {
+    if (enemies.empty()) return;
+    
+    if (!ownFlowField) {
+        flowField->invalidate();  // Last used by another room
+    }
+    flowField->update(this, playerPositions, camera.getOrigin());
+    
+    for (Enemy* enemy : enemies) {
+        if (!camera.contains(enemy->getPosition())) continue;  // Asleep or destroyed
+        if (!enemy->isReady()) continue;
+        
+        Point pos = enemy->getPosition();
+        Point bestPos = pos;
+        int best = flowField->getDistance(pos);
+        
+        for (int d = 1; d <= 4; d++) {
+            Point next = pos + directionToPoint((Direction)d);
+            int distance = flowField->getDistance(next);
+            if (distance < best && getElementAt(next) == nullptr) {
+                best = distance;
+                bestPos = next;
+            }
+        }
+        
+        if (bestPos != pos) {
+            moveElement(enemy, bestPos);
+            enemy->setCooldown(ENEMY_MOVE_INTERVAL - 1);
+        }
+    }
+}
+
+// Sends an enemy that hit a player back to its spawn (gone if the spawn is taken)
+void Room::respawnEnemy(Enemy* enemy) {
+    if (getElementAt(enemy->getSpawn()) == nullptr) {
+        moveElement(enemy, enemy->getSpawn());
+        enemy->setCooldown(ENEMY_RESPAWN_DELAY);
+    } else {
+        markElementAsCollected(enemy);
+    }
+}
+
+const std::vector<char>& Room::getStaticLayer(int layerWidth, int layerHeight) const {
+    Point origin = camera.getOrigin();
+    StaticLayer* layer = nullptr;
+    for (StaticLayer& cached : staticLayers) {
+        if (cached.width == layerWidth && cached.height == layerHeight) {
+            layer = &cached;
+            break;
+        }
+    }
+    if (!layer) {
+        staticLayers.push_back(StaticLayer{ layerWidth, layerHeight, -1, Point(-1, -1), {} });
+        layer = &staticLayers.back();
+    }
+    if (layer->version == layoutVersion && layer->origin == origin) {
+        return layer->cells;
+    }
+    
+    // Several room cells can share a layer cell, the one with the higher priority wins.
+    // Only the cells under the camera are looked at.
+    layer->version = layoutVersion;
+    layer->origin = origin;
+    layer->cells.assign(layerWidth * layerHeight, ' ');
+    visitRoomShape(cellElements.getShape(), [&](auto shape) { drawStaticCells<decltype(shape)::value>(*layer); });
+    return layer->cells;
+}
+
+template <RoomShape S>
+void Room::drawStaticCells(StaticLayer& layer) const {
+    const auto& elementCells = cellElements.as<S>();
+    Viewport view{ 0, 0, layer.width, layer.height, layer.origin.getX(), layer.origin.getY() };
+    int endX = std::min(layer.origin.getX() + SCREEN_WIDTH, elementCells.getWidth());
+    int endY = std::min(layer.origin.getY() + SCREEN_HEIGHT, elementCells.getHeight());
     
-    // Destroy adjacent walls (distance <= 1)
-    for (int dx = -1; dx <= 1; dx++) {
-        for (int dy = -1; dy <= 1; dy++) {
-            if (dx == 0 && dy == 0) continue;
+    for (int y = layer.origin.getY(); y < endY; y++) {
+        for (int x = layer.origin.getX(); x < endX; x++) {
+            GameElement* elem = elementCells.get(Point(x, y));
+            if (!elem || !isStatic(elem)) continue;
             
-            Point checkPos(bombPos.getX() + dx, bombPos.getY() + dy);
-            GameElement* elem = getElementAt(checkPos);
+            char& cell = layer.cells[view.mapY(y) * layer.width + view.mapX(x)];
+            if (getDrawPriority(elem->getDisplayChar()) >= getDrawPriority(cell)) {
+                cell = elem->getDisplayChar();
+            }
+        }
+    }
+}
+
+void Room::render(FrameBuffer& frame, const Viewport& view, const BitGrid* lit, const BitGrid* remembered) const {
+    Point origin = camera.getOrigin();
+    int endX = std::min(origin.getX() + SCREEN_WIDTH, width);
+    int endY = std::min(origin.getY() + SCREEN_HEIGHT, height);
+    
+    if (layout) {
+        renderStaticCells(frame, view, lit, remembered);
+    } else if (!lit) {
+        // Static part straight from the cache
+        const std::vector<char>& layer = getStaticLayer(view.width, view.height);
+        for (int y = 0; y < view.height; y++) {
+            for (int x = 0; x < view.width; x++) {
+                char ch = layer[y * view.width + x];
+                if (ch != ' ') {
+                    frame.plot(view.x + x, view.y + y, ch, getDrawPriority(ch));
+                }
+            }
+        }
+    } else {
+        // Darkness hides parts of it, filter at full size
+        const std::vector<char>& layer = getStaticLayer(SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (int y = origin.getY(); y < endY; y++) {
+            for (int x = origin.getX(); x < endX; x++) {
+                char ch = layer[(y - origin.getY()) * SCREEN_WIDTH + x - origin.getX()];
+                Point pos(x, y);
+                if (ch != ' ' && (lit->test(pos) || (remembered && remembered->test(pos) && ch == Chars::WALL))) {
+                    frame.plot(view.mapX(x), view.mapY(y), ch, getDrawPriority(ch));
+                }
+            }
+        }
+    }
+    
+    // Everything else, cell by cell under the camera
+    visitRoomShape(cellElements.getShape(), [&](auto shape) {
+        renderElements<decltype(shape)::value>(frame, view, lit);
+    });
+}
+
+void Room::renderStaticCells(FrameBuffer& frame, const Viewport& view,
+                             const BitGrid* lit, const BitGrid* remembered) const {
+    Point origin = camera.getOrigin();
+    int endX = std::min(origin.getX() + SCREEN_WIDTH, width);
+    int endY = std::min(origin.getY() + SCREEN_HEIGHT, height);
+    
+    for (int y = origin.getY(); y < endY; y++) {
+        for (int x = origin.getX(); x < endX; x++) {
+            Point pos(x, y);
+            GameElement* elem = getElementAt(pos);
+            if (!elem || !isStatic(elem)) continue;
             
-            if (elem && dynamic_cast<Wall*>(elem)) {
-                markElementAsCollected(elem);
+            char ch = elem->getDisplayChar();
+            if (!lit || lit->test(pos) || (remembered && remembered->test(pos) && ch == Chars::WALL)) {
+                frame.plot(view.mapX(x), view.mapY(y), ch, getDrawPriority(ch));
             }
         }
     }
+}
+
+template <RoomShape S>
+void Room::renderElements(FrameBuffer& frame, const Viewport& view, const BitGrid* lit) const {
+    const auto& elementCells = cellElements.as<S>();
+    const auto& springGrid = springCells.as<S>();
+    Point origin = camera.getOrigin();
+    int endX = std::min(origin.getX() + SCREEN_WIDTH, elementCells.getWidth());
+    int endY = std::min(origin.getY() + SCREEN_HEIGHT, elementCells.getHeight());
     
-    // Destroy other objects within radius 3
-    for (int dx = -3; dx <= 3; dx++) {
-        for (int dy = -3; dy <= 3; dy++) {
-            if (dx == 0 && dy == 0) continue;
+    for (int y = origin.getY(); y < endY; y++) {
+        for (int x = origin.getX(); x < endX; x++) {
+            Point pos(x, y);
+            if (lit && !lit->test(pos)) continue;
             
-            Point checkPos(bombPos.getX() + dx, bombPos.getY() + dy);
-            GameElement* elem = getElementAt(checkPos);
+            // Compressed chars disappear from the free end towards the wall
+            SpringCell springCell = springGrid.get(pos);
+            if (springCell.spring && springCell.offset < springCell.spring->getDisplayLength()) {
+                frame.plot(view.mapX(x), view.mapY(y), springCell.spring->getDisplayChar(), DRAW_PRIORITY_ITEM);
+                continue;
+            }
             
-            if (elem && !dynamic_cast<Wall*>(elem)) {
-                markElementAsCollected(elem);
+            GameElement* elem = elementCells.get(pos);
+            if (elem && !isStatic(elem) && !dynamic_cast<Spring*>(elem)) {
+                frame.plot(view.mapX(x), view.mapY(y), elem->getDisplayChar(), DRAW_PRIORITY_ITEM);
             }
         }
     }
 }
 
-void Room::draw() const {
-    for (const auto& elem : elements) {
-        if (elem) {
-            // Don't draw elements that are off-screen (collected)
-            Point pos = elem->getPosition();
-            if (pos.getX() >= 0 && pos.getX() < SCREEN_WIDTH &&
-                pos.getY() >= 0 && pos.getY() < SCREEN_HEIGHT) {
-                elem->draw();
+// Layout: P1-P8 on the first line, Life and Score below them,
+// P9-P16 to the right of Life and Score (4 per line)
+void Room::drawLegend(FrameBuffer& frame, const std::vector<std::unique_ptr<Player>>& players,
+                      int x, int y, int lives, int score) const {
+    // Formatted on the stack, the legend is drawn every frame
+    char text[24];
+    for (int i = 0; i < (int)players.size(); i++) {
+        char item = players[i]->hasItem() ? players[i]->getHeldItem()->getDisplayChar() : '-';
+        snprintf(text, sizeof(text), "P%d: %c", i + 1, item);
+        
+        if (i < 8) {
+            frame.print(x + 10 * i, y, text);
+        } else {
+            frame.print(x + 20 + 10 * ((i - 8) % 4), y + 1 + (i - 8) / 4, text);
+        }
+    }
+    
+    snprintf(text, sizeof(text), "Life: %d", lives);
+    frame.print(x, y + 1, text);
+    snprintf(text, sizeof(text), "Score: %d", score);
+    frame.print(x, y + 2, text);
+}
+
+int Room::getElementIndex(const GameElement* element) const {
+    if (level) {
+        for (const LoadedChunk& slot : chunkSlots) {
+            for (int i = 0; i < (int)slot.elements.size(); i++) {
+                if (slot.elements[i] == element) {
+                    return slot.chunk * CHUNK_SIZE * CHUNK_SIZE + i;
+                }
             }
         }
+        return -1;
     }
+    
+    for (int i = 0; i < (int)elements.size(); i++) {
+        if (elements[i].get() == element) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-void Room::drawLegend(Player* p1, Player* p2, int x, int y, int lives, int score) const {
-    gotoxy(x, y);
-    std::cout << "P1: ";
-    if (p1->hasItem()) {
-        std::cout << p1->getHeldItem()->getDisplayChar();
-    } else {
-        std::cout << "-";
+GameElement* Room::getElementByIndex(int index) const {
+    if (level) {
+        int slot = index >= 0 ? findChunkSlot(index / (CHUNK_SIZE * CHUNK_SIZE)) : -1;
+        int i = index % (CHUNK_SIZE * CHUNK_SIZE);
+        if (slot < 0 || i >= (int)chunkSlots[slot].elements.size()) return nullptr;
+        return chunkSlots[slot].elements[i];
     }
     
-    gotoxy(x + 10, y);
-    std::cout << "P2: ";
-    if (p2->hasItem()) {
-        std::cout << p2->getHeldItem()->getDisplayChar();
-    } else {
-        std::cout << "-";
+    if (index < 0 || index >= (int)elements.size()) return nullptr;
+    return elements[index].get();
+}
+
+// Position plus three values whatever the type, so that every value keeps
+// its place in the state from one tick to the next
+void Room::writeElement(StateWriter& out, const GameElement* element) {
+    int values[3] = { 0, 0, 0 };
+    
+    if (const Switch* sw = dynamic_cast<const Switch*>(element)) {
+        values[0] = sw->getIsOn();
+    } else if (const Bomb* bomb = dynamic_cast<const Bomb*>(element)) {
+        values[0] = bomb->isActivated();
+        values[1] = bomb->getTicksRemaining();
+        values[2] = bomb->hasDetonated();
+    } else if (const Spring* spring = dynamic_cast<const Spring*>(element)) {
+        values[0] = spring->getCompressedLength();
+    } else if (const Enemy* enemy = dynamic_cast<const Enemy*>(element)) {
+        values[0] = enemy->getCooldown();
     }
     
-    gotoxy(x, y + 1);
-    std::cout << "Life: " << lives;
+    out.writePoint(element->getPosition());
+    for (int value : values) {
+        out.writeInt(value);
+    }
+}
+
+// Element moves need two passes (they may trade cells), so the values are
+// gone through twice. Lift everything that moved first...
+void Room::liftIfMoved(GameElement* element, StateReader& in) {
+    Point pos = in.readPoint();
+    for (int v = 0; v < 3; v++) {
+        in.readInt();
+    }
+    if (element->getPosition() == pos) return;
     
-    gotoxy(x, y + 2);
-    std::cout << "Score: " << score;
+    if (Spring* spring = dynamic_cast<Spring*>(element)) {
+        setSpringCells(spring, nullptr);
+    }
+    moveElement(element, Point(-100, -100));
+}
+
+// ...then put it down where it was and restore the rest
+void Room::restoreElement(GameElement* element, StateReader& in) {
+    Point pos = in.readPoint();
+    int values[3];
+    for (int& value : values) {
+        value = in.readInt();
+    }
+    
+    if (element->getPosition() != pos) {
+        moveElement(element, pos);
+        if (Spring* spring = dynamic_cast<Spring*>(element)) {
+            if (pos != Point(-100, -100)) {
+                setSpringCells(spring, spring);
+            }
+        }
+    }
+    
+    if (Switch* sw = dynamic_cast<Switch*>(element)) {
+        sw->setOn(values[0] != 0);
+    } else if (Bomb* bomb = dynamic_cast<Bomb*>(element)) {
+        bomb->restoreState(values[0] != 0, values[1], values[2] != 0);
+    } else if (Spring* spring = dynamic_cast<Spring*>(element)) {
+        spring->compress(values[0]);
+    } else if (Enemy* enemy = dynamic_cast<Enemy*>(element)) {
+        enemy->setCooldown(values[0]);
+    }
+}
+
+// Both passes over targets, values as written by writeElement
+void Room::restoreElements(const std::vector<GameElement*>& targets, const StateVector& values) {
+    if (values.size() != targets.size() * 5) return;  // The level file changed since
+    
+    StateReader lift(values);
+    for (GameElement* element : targets) {
+        liftIfMoved(element, lift);
+    }
+    StateReader in(values);
+    for (GameElement* element : targets) {
+        restoreElement(element, in);
+    }
+}
+
+// Large rooms write each loaded chunk with its elements, a chunk's elements
+// always come in the same order so its values keep their place while it stays
+void Room::writeState(StateWriter& out, bool complete) const {
+    triggers.writeCounts(out);
+    
+    if (!level) {
+        out.writeInt((int)elements.size());
+        for (const auto& element : elements) {
+            writeElement(out, element.get());
+        }
+        for (bool gone : wallsGone) {
+            out.writeBool(gone);  // Shared walls, see RoomLayout
+        }
+        return;
+    }
+    
+    // Unloaded chunks don't change, only saves carry them
+    out.writeBool(complete);
+    if (complete) {
+        int count = 0;
+        for (const auto& entry : unloadedChunks) {
+            count += loadedChunks[entry.first] ? 0 : 1;
+        }
+        out.writeInt(count);
+        for (const auto& entry : unloadedChunks) {
+            if (loadedChunks[entry.first]) continue;
+            out.writeInt(entry.first);
+            out.writeInt((int)entry.second.size());
+            for (int value : entry.second) {
+                out.writeInt(value);
+            }
+        }
+    }
+    
+    out.writeInt((int)chunkSlots.size());
+    for (const LoadedChunk& slot : chunkSlots) {
+        out.writeInt(slot.chunk);
+        out.writeInt((int)slot.elements.size());
+        for (const GameElement* element : slot.elements) {
+            writeElement(out, element);
+        }
+    }
+}
+
+bool Room::readState(StateReader& in) {
+    triggers.readCounts(in);
+    
+    if (!level) {
+        int count = in.readInt();
+        if (count < 0 || count > (int)elements.size()) {
+            in.fail();  // Written with different screen files
+        }
+        if (in.hasFailed()) return false;
+        
+        StateReader lift = in;
+        for (int i = 0; i < count; i++) {
+            liftIfMoved(elements[i].get(), lift);
+        }
+        if (lift.hasFailed()) {
+            in.fail();
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            restoreElement(elements[i].get(), in);
+        }
+        for (int i = 0; i < (int)wallsGone.size(); i++) {
+            bool gone = in.readBool();
+            if (gone != wallsGone[i]) {
+                wallsGone[i] = gone;
+                layoutVersion++;
+            }
+        }
+        return !in.hasFailed();
+    }
+    
+    int chunkTotal = (int)loadedChunks.size();
+    int maxValues = CHUNK_SIZE * CHUNK_SIZE * 5;
+    if (in.readBool()) {
+        int count = in.readInt();
+        if (count < 0 || count > chunkTotal) {
+            in.fail();
+        }
+        unloadedChunks.clear();
+        for (int i = 0; i < count && !in.hasFailed(); i++) {
+            int chunk = in.readInt();
+            int size = in.readInt();
+            if (chunk < 0 || chunk >= chunkTotal || size < 0 || size > maxValues) {
+                in.fail();
+                break;
+            }
+            StateVector& values = unloadedChunks[chunk];
+            values.resize(size);
+            for (int& value : values) {
+                value = in.readInt();
+            }
+        }
+    }
+    
+    // Read the chunk list ahead, then load and unload chunks to match it
+    int chunkCount = in.readInt();
+    if (chunkCount < 0 || chunkCount > chunkTotal) {
+        in.fail();
+    }
+    stateChunks.clear();
+    StateReader scan = in;
+    for (int i = 0; i < chunkCount && !scan.hasFailed(); i++) {
+        int chunk = scan.readInt();
+        int count = scan.readInt();
+        if (chunk < 0 || chunk >= chunkTotal || count < 0 || count > CHUNK_SIZE * CHUNK_SIZE) {
+            scan.fail();
+            break;
+        }
+        stateChunks.push_back(chunk);
+        for (int v = 0; v < count * 5; v++) {
+            scan.readInt();
+        }
+    }
+    if (scan.hasFailed()) {
+        in.fail();
+    }
+    if (in.hasFailed()) return false;
+    
+    // Chunks loaded since are dropped with their changes, unless something
+    // still depends on them (see canUnloadChunk), then they stay as they are
+    std::sort(stateChunks.begin(), stateChunks.end());
+    const std::vector<const GameElement*> noneHeld;  // The players' items are restored after the rooms
+    for (int i = (int)chunkSlots.size() - 1; i >= 0; i--) {
+        if (!std::binary_search(stateChunks.begin(), stateChunks.end(), chunkSlots[i].chunk) &&
+            canUnloadChunk(chunkSlots[i], noneHeld)) {
+            unloadChunk(i, false);
+        }
+    }
+    for (int chunk : stateChunks) {
+        if (!loadedChunks[chunk]) {
+            loadChunk(chunk);
+        }
+    }
+    
+    StateReader lift = in;
+    for (int i = 0; i < chunkCount && !lift.hasFailed(); i++) {
+        const LoadedChunk& slot = chunkSlots[findChunkSlot(lift.readInt())];
+        if (lift.readInt() != (int)slot.elements.size()) {
+            lift.fail();  // Written with a different level file
+        }
+        for (int e = 0; e < (int)slot.elements.size() && !lift.hasFailed(); e++) {
+            liftIfMoved(slot.elements[e], lift);
+        }
+    }
+    if (lift.hasFailed()) {
+        in.fail();
+        return false;
+    }
+    for (int i = 0; i < chunkCount; i++) {
+        const LoadedChunk& slot = chunkSlots[findChunkSlot(in.readInt())];
+        in.readInt();
+        for (GameElement* element : slot.elements) {
+            restoreElement(element, in);
+        }
+    }
+    
+    // Idle cycles before a rewind don't count, the frames after it are played again
+    for (LoadedChunk& slot : chunkSlots) {
+        slot.idleTicks = 0;
+    }
+    return !in.hasFailed();
 }
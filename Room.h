@@ -10,52 +10,205 @@
 #include "Riddle.h"
 #include "Switch.h"
 #include "Spring.h"
+#include "Enemy.h"
 #include "Player.h"
+#include "TriggerGraph.h"
+#include "BitGrid.h"
+#include "DistanceField.h"
+#include "FrameBuffer.h"
+#include "RoomGrid.h"
+#include "RoomLayout.h"
+#include "Camera.h"
+#include "LevelFormat.h"
+#include "ChunkedLevel.h"
+#include "SaveFile.h"
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 class Room {
 private:
     int roomId;
     bool isFinalRoom;
+    int width;   // Rooms can be larger than the screen, the camera shows a part of them
+    int height;
     std::vector<std::unique_ptr<GameElement>> elements;
+    RoomGrid<GameElement*> cellElements;  // cell -> element on it
     
     // Quick access lists (non-owning pointers)
+    std::vector<Key*> keys;
     std::vector<Door*> doors;
-    std::vector<Bomb*> bombs;
+    std::vector<Bomb*> bombs;  // Detonated ones too, a rewind can put them back
     std::vector<Obstacle*> obstacles;
     std::vector<Riddle*> riddles;
     std::vector<Switch*> switches;
     std::vector<Spring*> springs;
+    std::vector<Enemy*> enemies;
+    RoomGrid<SpringCell> springCells;  // cell -> (spring, offset)
+    
+    void setSpringCells(Spring* spring, Spring* value);
+    
+    TriggerGraph triggers;  // Switch groups -> doors, walls, bombs
+    int layoutVersion;      // Bumped whenever a wall or obstacle moves or disappears
+    std::unique_ptr<DistanceField> ownFlowField;  // Steps to the nearest player, shared by all enemies
+    DistanceField* flowField;  // ownFlowField, or one that other rooms use too (no own one then)
+    
+    // Rooms of a shared layout: the walls belong to it, the room only knows
+    // which of them are gone. cellElements and springCells hold the rest.
+    const RoomLayout* layout;
+    std::vector<bool> wallsGone;  // Per layout wall
+    
+    // Bomb chain reactions (scratch, reused every tick)
+    struct PendingBlast {
+        Bomb* bomb;
+        Point center;
+    };
+    std::vector<PendingBlast> pendingBlasts;
+    BitGrid blastVisited;
+    std::vector<Point> detonations;  // Since the last takeDetonations, for telemetry
+    
+    // Walls and obstacles under the camera, pre-drawn at one viewport size and
+    // rebuilt only when the layout version changes or the camera scrolls
+    struct StaticLayer {
+        int width;
+        int height;
+        int version;
+        Point origin;
+        std::vector<char> cells;
+    };
+    mutable std::vector<StaticLayer> staticLayers;
+    const std::vector<char>& getStaticLayer(int layerWidth, int layerHeight) const;
+    
+    // Cell loops under the camera, compiled once per RoomShape
+    template <RoomShape S>
+    void drawStaticCells(StaticLayer& layer) const;
+    template <RoomShape S>
+    void renderElements(FrameBuffer& frame, const Viewport& view, const BitGrid* lit) const;
+    // Rooms of a shared layout draw walls and obstacles without the cache,
+    // a layer per game would cost more than the walls it saves looking up
+    void renderStaticCells(FrameBuffer& frame, const Viewport& view,
+                           const BitGrid* lit, const BitGrid* remembered) const;
+    
+    // Large rooms: chunks are read from the level file on demand and unloaded
+    // again once nothing has been near them for CHUNK_UNLOAD_TICKS cycles, so
+    // elements, grid memory and the state written every cycle follow the area
+    // around the cameras and players, not the area explored. A chunk that was
+    // changed keeps its element state in unloadedChunks, the file has the rest.
+    struct LoadedChunk {
+        int chunk;        // Index in the level, row by row
+        bool pinned;      // Trigger target, stays loaded
+        int idleTicks;    // Cycles no camera or player has been near it
+        std::vector<GameElement*> elements;  // Added by this chunk, in load order
+        StateVector pristine;                // Their state as read from the file
+    };
+    Camera camera;
+    std::unique_ptr<ChunkedLevel> level;
+    std::vector<bool> loadedChunks;
+    std::vector<LoadedChunk> chunkSlots;  // Loaded chunks, in load order
+    std::unordered_map<int, StateVector> unloadedChunks;  // chunk -> element state when last unloaded
+    std::vector<int> stateChunks;          // Scratch for readState
+    std::vector<GameElement*> chunkScratch;  // Sorted elements of the chunk being unloaded
+    bool switchesPreCounted;  // Switch groups were counted by the level, not by addElement
+    
+    static bool isStatic(const GameElement* element);  // Walls and obstacles
+    void runBlasts();
+    
+    int getChunkIndex(Point pos) const;
+    Point getChunkOrigin(int chunk) const;
+    int findChunkSlot(int chunk) const;  // Index in chunkSlots, -1 if not loaded
+    void loadChunk(int chunk);
+    bool isChunkNear(int chunk, Point center, int rangeX, int rangeY) const;
+    bool canUnloadChunk(const LoadedChunk& slot, const std::vector<const GameElement*>& heldItems);
+    void unloadChunk(int slotIndex, bool keepState);  // keepState = false drops its changes (readState)
+    void releaseGridChunk(int chunk);                 // Frees the chunk's cells if nothing is left on them
+    void unloadIdleChunks(const std::vector<Point>& playerPositions, const std::vector<const GameElement*>& heldItems);
+    
+    // Element state: position and three values, whatever the type
+    static void writeElement(StateWriter& out, const GameElement* element);
+    void liftIfMoved(GameElement* element, StateReader& in);  // First pass of a restore
+    void restoreElement(GameElement* element, StateReader& in);
+    void restoreElements(const std::vector<GameElement*>& targets, const StateVector& values);
     
 public:
-    Room(int id, bool finalRoom = false);
+    Room(int id, bool finalRoom = false, int roomWidth = SCREEN_WIDTH, int roomHeight = SCREEN_HEIGHT);
+    // Screen-sized room on a shared layout (kept alive by the caller): wall
+    // records are skipped, the layout has them. The enemies use sharedFlowField,
+    // rooms using the same one must not be updated at the same time.
+    Room(int id, bool finalRoom, const RoomLayout* sharedLayout, DistanceField* sharedFlowField);
     
     // Prevent copying
     Room(const Room&) = delete;
     Room& operator=(const Room&) = delete;
     
     int getId() const { return roomId; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool isInside(Point pos) const;
+    const Camera& getCamera() const { return camera; }
+    
+    void setLevel(std::unique_ptr<ChunkedLevel> chunkedLevel);
+    void loadChunkAt(Point pos, bool pin = false);
+    void loadChunksAround(Point center, int rangeX, int rangeY);
+    
     bool getIsFinalRoom() const { return isFinalRoom; }
     
     void addElement(std::unique_ptr<GameElement> element);
+    bool addElementFromChar(char ch, Point pos, const TriggerWiring& wiring);
+    bool addElementFromRecord(const LevelRecord& record);
     GameElement* getElementAt(Point pos) const;
     void markElementAsCollected(GameElement* element);  // NEW - instead of removeElement
+    bool placeElement(GameElement* element, Point pos);  // Fails if the cell is taken
+    void moveElement(GameElement* element, Point newPos);
     
     bool isPositionWalkable(Point pos) const;
     bool isWall(Point pos) const;
+    bool blocksSight(Point pos) const;  // Walls, obstacles and everything off-screen
+    int getLayoutVersion() const { return layoutVersion; }
     Door* getDoorAt(Point pos) const;
     Obstacle* getObstacleAt(Point pos) const;
     Riddle* getRiddleAt(Point pos) const;
     Switch* getSwitchAt(Point pos) const;
     Spring* getSpringAt(Point pos) const;
+    SpringCell getSpringCellAt(Point pos) const;  // Single lookup, {nullptr, -1} if no spring
+    
+    // Stable element numbering, used by saves to refer to elements: load order,
+    // or chunk * CHUNK_SIZE^2 + load order within the chunk in large rooms
+    int getElementIndex(const GameElement* element) const;  // -1 if not in this room
+    GameElement* getElementByIndex(int index) const;
+    
+    // State of every element and switch group, for quick-saves and rewinding.
+    // readState works on the room loaded from the same files, fresh or played,
+    // and returns false if the state doesn't fit it. In large rooms only the
+    // loaded chunks are written; complete adds the changed chunks that are
+    // unloaded (saves need them, rewind frames don't: nothing changes in an
+    // unloaded chunk). Reading loads and unloads chunks to match the state.
+    void writeState(StateWriter& out, bool complete) const;
+    bool readState(StateReader& in);
+    
+    // Everything added (in large rooms: by the loaded chunks), collected elements are off-screen
+    const std::vector<Key*>& getKeys() const { return keys; }
+    const std::vector<Door*>& getDoors() const { return doors; }
+    const std::vector<Switch*>& getSwitches() const { return switches; }
     
-    bool areSwitchesActivated(int groupId) const;
+    bool areSwitchesActivated(int groupId) const;  // O(1), kept up to date by the trigger graph
+    void addTrigger(int groupId, TriggerAction action);
+    void runTriggerAction(const TriggerAction& action);
     
+    // One simulation step of everything that runs on its own (bombs, enemies),
+    // after moving the camera and loading the chunks near the players.
+    // Touches nothing outside this room, so rooms can be stepped in parallel.
+    // Chunks holding an item in heldItems (any room's) stay loaded.
+    void update(const std::vector<Point>& playerPositions, const std::vector<const GameElement*>& heldItems);
     void updateBombs();
-    void explodeBomb(Bomb* bomb);
+    void updateEnemies(const std::vector<Point>& playerPositions);
+    void respawnEnemy(Enemy* enemy);
+    void takeDetonations(std::vector<Point>& out);  // Appends and forgets them
     bool tryPushObstacle(Obstacle* obs, Direction dir);
     
-    void draw() const;
-    void drawLegend(Player* p1, Player* p2, int x, int y, int lives, int score) const;
+    // Draws what the camera sees into a viewport of the frame. In dark mode
+    // (lit != nullptr) only lit cells show everything, remembered cells only show walls.
+    void render(FrameBuffer& frame, const Viewport& view,
+                const BitGrid* lit = nullptr, const BitGrid* remembered = nullptr) const;
+    void drawLegend(FrameBuffer& frame, const std::vector<std::unique_ptr<Player>>& players,
+                    int x, int y, int lives, int score) const;
 };
@@ -0,0 +1,171 @@
+#pragma once
+#include "ChunkGrid.h"
+#include "SparseGrid.h"
+#include <variant>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+// Dense W x H grid with the size compiled in: bounds checks and cell
+// indices fold into constants, and lookups touch no cache, so const lookups
+// may run on several threads at once (unlike ChunkGrid).
+template <typename T, int W, int H>
+class FixedGrid {
+private:
+    std::unique_ptr<T[]> cells;
+    T fallback;
+
+public:
+    explicit FixedGrid(T fallbackValue) : cells(new T[W * H]), fallback(fallbackValue) {
+        reset();
+    }
+
+    static constexpr int getWidth() { return W; }
+    static constexpr int getHeight() { return H; }
+
+    static constexpr bool isInside(Point pos) {
+        return (unsigned)pos.getX() < (unsigned)W && (unsigned)pos.getY() < (unsigned)H;
+    }
+
+    const T& get(Point pos) const {
+        return isInside(pos) ? cells[pos.getY() * W + pos.getX()] : fallback;
+    }
+
+    // Cells outside the grid are ignored
+    void set(Point pos, const T& value) {
+        if (isInside(pos)) cells[pos.getY() * W + pos.getX()] = value;
+    }
+
+    void reset() { std::fill(cells.get(), cells.get() + W * H, fallback); }
+};
+
+// Storage picked when a room is created, from its size
+enum class RoomShape {
+    SCREEN,   // SCREEN_WIDTH x SCREEN_HEIGHT, every screen file room
+    PUZZLE,   // PUZZLE_ROOM_WIDTH x PUZZLE_ROOM_HEIGHT
+    ARENA,    // ARENA_ROOM_WIDTH x ARENA_ROOM_HEIGHT
+    CHUNKED,  // Any other size, ChunkGrid
+    SPARSE    // Any size with few cells set, SparseGrid (asked for by the room)
+};
+
+constexpr RoomShape getRoomShape(int width, int height) {
+    if (width == SCREEN_WIDTH && height == SCREEN_HEIGHT) return RoomShape::SCREEN;
+    if (width == PUZZLE_ROOM_WIDTH && height == PUZZLE_ROOM_HEIGHT) return RoomShape::PUZZLE;
+    if (width == ARENA_ROOM_WIDTH && height == ARENA_ROOM_HEIGHT) return RoomShape::ARENA;
+    return RoomShape::CHUNKED;
+}
+
+// Per-cell room storage of any size: one of the FixedGrid sizes, a ChunkGrid
+// for everything else, or a SparseGrid when the room asks for one. get / set switch on the shape (which never
+// changes, so the branch is free) and then run the fixed-size code.
+// Loops over many cells should go through as<Shape>() once instead, see
+// Room::render.
+template <typename T>
+class RoomGrid {
+public:
+    typedef FixedGrid<T, SCREEN_WIDTH, SCREEN_HEIGHT> ScreenGrid;
+    typedef FixedGrid<T, PUZZLE_ROOM_WIDTH, PUZZLE_ROOM_HEIGHT> PuzzleGrid;
+    typedef FixedGrid<T, ARENA_ROOM_WIDTH, ARENA_ROOM_HEIGHT> ArenaGrid;
+
+private:
+    // Alternatives in RoomShape order
+    typedef std::variant<ScreenGrid, PuzzleGrid, ArenaGrid, ChunkGrid<T>, SparseGrid<T>> Cells;
+    Cells cells;
+
+    static Cells create(int width, int height, T fallback, bool sparse) {
+        if (sparse) return Cells(std::in_place_index<4>, width, height, fallback);
+        switch (getRoomShape(width, height)) {
+            case RoomShape::SCREEN: return Cells(std::in_place_index<0>, fallback);
+            case RoomShape::PUZZLE: return Cells(std::in_place_index<1>, fallback);
+            case RoomShape::ARENA: return Cells(std::in_place_index<2>, fallback);
+            default: return Cells(std::in_place_index<3>, width, height, fallback);
+        }
+    }
+
+public:
+    RoomGrid(int width, int height, T fallback, bool sparse = false)
+        : cells(create(width, height, fallback, sparse)) {}
+
+    RoomShape getShape() const { return (RoomShape)cells.index(); }
+
+    // The grid behind a shape, only valid for getShape()
+    template <RoomShape S>
+    const auto& as() const { return *std::get_if<(size_t)S>(&cells); }
+    template <RoomShape S>
+    auto& as() { return *std::get_if<(size_t)S>(&cells); }
+
+    int getWidth() const {
+        switch (getShape()) {
+            case RoomShape::SCREEN: return ScreenGrid::getWidth();
+            case RoomShape::PUZZLE: return PuzzleGrid::getWidth();
+            case RoomShape::ARENA: return ArenaGrid::getWidth();
+            case RoomShape::SPARSE: return as<RoomShape::SPARSE>().getWidth();
+            default: return as<RoomShape::CHUNKED>().getWidth();
+        }
+    }
+
+    int getHeight() const {
+        switch (getShape()) {
+            case RoomShape::SCREEN: return ScreenGrid::getHeight();
+            case RoomShape::PUZZLE: return PuzzleGrid::getHeight();
+            case RoomShape::ARENA: return ArenaGrid::getHeight();
+            case RoomShape::SPARSE: return as<RoomShape::SPARSE>().getHeight();
+            default: return as<RoomShape::CHUNKED>().getHeight();
+        }
+    }
+
+    bool isInside(Point pos) const {
+        switch (getShape()) {
+            case RoomShape::SCREEN: return ScreenGrid::isInside(pos);
+            case RoomShape::PUZZLE: return PuzzleGrid::isInside(pos);
+            case RoomShape::ARENA: return ArenaGrid::isInside(pos);
+            case RoomShape::SPARSE: return as<RoomShape::SPARSE>().isInside(pos);
+            default: return as<RoomShape::CHUNKED>().isInside(pos);
+        }
+    }
+
+    const T& get(Point pos) const {
+        switch (getShape()) {
+            case RoomShape::SCREEN: return as<RoomShape::SCREEN>().get(pos);
+            case RoomShape::PUZZLE: return as<RoomShape::PUZZLE>().get(pos);
+            case RoomShape::ARENA: return as<RoomShape::ARENA>().get(pos);
+            case RoomShape::SPARSE: return as<RoomShape::SPARSE>().get(pos);
+            default: return as<RoomShape::CHUNKED>().get(pos);
+        }
+    }
+
+    void set(Point pos, const T& value) {
+        switch (getShape()) {
+            case RoomShape::SCREEN: as<RoomShape::SCREEN>().set(pos, value); break;
+            case RoomShape::PUZZLE: as<RoomShape::PUZZLE>().set(pos, value); break;
+            case RoomShape::ARENA: as<RoomShape::ARENA>().set(pos, value); break;
+            case RoomShape::SPARSE: as<RoomShape::SPARSE>().set(pos, value); break;
+            default: as<RoomShape::CHUNKED>().set(pos, value); break;
+        }
+    }
+
+    void reset() {
+        std::visit([](auto& grid) { grid.reset(); }, cells);
+    }
+
+    // Frees the CHUNK_SIZE chunk holding pos in a chunked grid. The other shapes
+    // keep their memory, the caller has already set those cells back.
+    void releaseChunk(Point pos) {
+        if (getShape() == RoomShape::CHUNKED) {
+            as<RoomShape::CHUNKED>().releaseChunk(pos);
+        }
+    }
+};
+
+// Calls visit(std::integral_constant<RoomShape, S>()) for the shape, so a
+// generic lambda can instantiate its cell loop once per shape
+template <typename Visit>
+void visitRoomShape(RoomShape shape, Visit&& visit) {
+    switch (shape) {
+        case RoomShape::SCREEN: visit(std::integral_constant<RoomShape, RoomShape::SCREEN>()); break;
+        case RoomShape::PUZZLE: visit(std::integral_constant<RoomShape, RoomShape::PUZZLE>()); break;
+        case RoomShape::ARENA: visit(std::integral_constant<RoomShape, RoomShape::ARENA>()); break;
+        case RoomShape::SPARSE: visit(std::integral_constant<RoomShape, RoomShape::SPARSE>()); break;
+        default: visit(std::integral_constant<RoomShape, RoomShape::CHUNKED>()); break;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Wall.h"
+#include "LevelTable.h"
+#include <vector>
+#include <functional>
+
+// The walls of one level table, built once and shared read-only by every room
+// loaded from that table (the session server's games). Such a room creates
+// only the other elements and keeps one "gone" flag per shared wall, so a
+// game pays for what can change in a level, not for its walls.
+class RoomLayout {
+private:
+    std::vector<Wall> walls;       // In record order, never resized after construction
+    std::vector<short> wallCells;  // cell -> index in walls, -1 = none
+
+public:
+    explicit RoomLayout(const LevelTable& level) : wallCells(SCREEN_WIDTH * SCREEN_HEIGHT, -1) {
+        for (int r = 0; r < level.recordCount; r++) {
+            Point pos = level.records[r].pos;
+            if (level.records[r].kind == ElementKind::WALL && findWall(pos) < 0 &&
+                pos.getX() >= 0 && pos.getX() < SCREEN_WIDTH && pos.getY() >= 0 && pos.getY() < SCREEN_HEIGHT) {
+                wallCells[pos.getY() * SCREEN_WIDTH + pos.getX()] = (short)walls.size();
+                walls.push_back(Wall(pos));
+            }
+        }
+    }
+
+    int getWallCount() const { return (int)walls.size(); }
+
+    // Index of the wall at pos, -1 if there is none
+    int findWall(Point pos) const {
+        if (pos.getX() < 0 || pos.getX() >= SCREEN_WIDTH || pos.getY() < 0 || pos.getY() >= SCREEN_HEIGHT) {
+            return -1;
+        }
+        return wallCells[pos.getY() * SCREEN_WIDTH + pos.getX()];
+    }
+
+    // Handed out like a room's own elements. Nothing moves a shared wall, a
+    // room hides the ones it lost instead (Room::markElementAsCollected).
+    GameElement* getWall(int index) const { return const_cast<Wall*>(&walls[index]); }
+
+    // Index of element in walls, -1 if it isn't one of them
+    int getWallIndex(const GameElement* element) const {
+        std::less<const GameElement*> before;
+        if (walls.empty() || before(element, &walls.front()) || before(&walls.back(), element)) {
+            return -1;
+        }
+        return (int)(static_cast<const Wall*>(element) - walls.data());
+    }
+};
@@ -0,0 +1,81 @@
+#include "SaveFile.h"
+
+static const char SAVE_MAGIC[4] = { 'T', 'A', 'G', 'S' };
+
+// Zigzag (small negatives stay small), then 7 bits per byte, high bit = more to come
+static void writeVarint(std::vector<char>& bytes, int value) {
+    unsigned int bits = ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+    while (bits >= 0x80) {
+        bytes.push_back((char)(bits | 0x80));
+        bits >>= 7;
+    }
+    bytes.push_back((char)bits);
+}
+
+static bool readVarint(const unsigned char* data, size_t size, size_t& offset, int& value) {
+    unsigned int bits = 0;
+    for (int shift = 0; shift < 35 && offset < size; shift += 7) {
+        unsigned char byte = data[offset++];
+        bits |= (unsigned int)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = (int)(bits >> 1) ^ -(int)(bits & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void encodeSave(const StateVector& state, std::vector<char>& bytes) {
+    bytes.assign(SAVE_MAGIC, SAVE_MAGIC + 4);
+    writeVarint(bytes, SAVE_FORMAT_VERSION);
+    writeVarint(bytes, (int)state.size());
+    for (int value : state) {
+        writeVarint(bytes, value);
+    }
+}
+
+bool decodeSave(const char* data, size_t size, StateVector& state) {
+    if (size < 4 || std::char_traits<char>::compare(data, SAVE_MAGIC, 4) != 0) {
+        return false;
+    }
+    
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t offset = 4;
+    int version = 0, count = 0;
+    if (!readVarint(bytes, size, offset, version) || version != SAVE_FORMAT_VERSION ||
+        !readVarint(bytes, size, offset, count) || count < 0 || (size_t)count > size) {
+        return false;
+    }
+    
+    state.resize(count);
+    for (int i = 0; i < count; i++) {
+        if (!readVarint(bytes, size, offset, state[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MappedFile::MappedFile(const std::string& filename)
+    : file(INVALID_HANDLE_VALUE), mapping(nullptr), view(nullptr), size(0) {
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;  // Empty files can't be mapped
+    
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return;
+    
+    view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view) {
+        size = (size_t)fileSize.QuadPart;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
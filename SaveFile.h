@@ -0,0 +1,86 @@
+#pragma once
+#include "GameConfig.h"
+#include "Point.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// Game state as a flat sequence of ints (see Game::writeState). Every value
+// keeps its index from one tick to the next as long as no elements are added
+// or removed (chunks of large rooms loading and unloading),
+// which is what the rewind buffer diffs on.
+typedef std::vector<int> StateVector;
+
+class StateWriter {
+private:
+    StateVector& values;
+
+public:
+    explicit StateWriter(StateVector& target) : values(target) {}
+
+    void writeInt(int value) { values.push_back(value); }
+    void writeBool(bool value) { values.push_back(value ? 1 : 0); }
+    void writePoint(Point pos) {
+        values.push_back(pos.getX());
+        values.push_back(pos.getY());
+    }
+};
+
+// Reading past the end sets the failed flag and returns zeros,
+// callers check hasFailed() once at the end
+class StateReader {
+private:
+    const StateVector& values;
+    size_t offset;
+    bool failed;
+
+public:
+    explicit StateReader(const StateVector& source) : values(source), offset(0), failed(false) {}
+
+    int readInt() {
+        if (offset >= values.size()) {
+            failed = true;
+            return 0;
+        }
+        return values[offset++];
+    }
+    bool readBool() { return readInt() != 0; }
+    Point readPoint() {
+        int x = readInt();
+        int y = readInt();
+        return Point(x, y);
+    }
+
+    bool hasFailed() const { return failed; }
+    void fail() { failed = true; }
+};
+
+// Quick-save file: "TAGS", a format version, then the state vector as zigzag
+// varints, so the small positions and counters that make up most of it take
+// one byte each. Bump SAVE_FORMAT_VERSION whenever the order or meaning of the
+// values changes, older saves are then refused instead of being misread.
+const int SAVE_FORMAT_VERSION = 4;
+
+void encodeSave(const StateVector& state, std::vector<char>& bytes);
+bool decodeSave(const char* data, size_t size, StateVector& state);  // false on a bad header or truncated data
+
+// Read-only view of a whole file through a file mapping, the save is decoded in place
+class MappedFile {
+private:
+    HANDLE file;
+    HANDLE mapping;
+    const char* view;
+    size_t size;
+
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    // Prevent copying (owns the handles)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return view != nullptr; }
+    const char* getData() const { return view; }
+    size_t getSize() const { return size; }
+};
@@ -0,0 +1,108 @@
+#include "ScreenWatcher.h"
+#include "AllocTracker.h"
+#include <algorithm>
+
+ScreenWatcher::ScreenWatcher()
+    : directory(INVALID_HANDLE_VALUE), changedEvent(nullptr), overlapped(), watching(false) {}
+
+ScreenWatcher::~ScreenWatcher() {
+    stop();
+}
+
+bool ScreenWatcher::start(const std::string& directoryPath, const std::string& nameSuffix) {
+    stop();
+    suffix = nameSuffix;
+    
+    directory = CreateFileA(directoryPath.c_str(), FILE_LIST_DIRECTORY,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (directory == INVALID_HANDLE_VALUE) return false;
+    
+    changedEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!changedEvent) {
+        stop();
+        return false;
+    }
+    
+    watching = requestChanges();
+    if (!watching) stop();
+    return watching;
+}
+
+void ScreenWatcher::stop() {
+    if (watching) {
+        // The pending read writes into buffer, wait until it is really cancelled
+        DWORD bytes = 0;
+        CancelIo(directory);
+        GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+        watching = false;
+    }
+    if (changedEvent) {
+        CloseHandle(changedEvent);
+        changedEvent = nullptr;
+    }
+    if (directory != INVALID_HANDLE_VALUE) {
+        CloseHandle(directory);
+        directory = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool ScreenWatcher::requestChanges() {
+    overlapped = OVERLAPPED();
+    overlapped.hEvent = changedEvent;
+    return ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE,
+                                 FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE |
+                                 FILE_NOTIFY_CHANGE_FILE_NAME,
+                                 nullptr, &overlapped, nullptr) != 0;
+}
+
+bool ScreenWatcher::hasSuffix(const FILE_NOTIFY_INFORMATION* info) const {
+    int length = (int)(info->FileNameLength / sizeof(WCHAR));
+    int start = length - (int)suffix.size();
+    if (start < 0) return false;
+    for (int i = 0; i < (int)suffix.size(); i++) {
+        if (info->FileName[start + i] != (WCHAR)(unsigned char)suffix[i]) return false;
+    }
+    return true;
+}
+
+bool ScreenWatcher::poll(std::vector<std::string>& changedFiles) {
+    if (!watching) return false;
+    
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE)) {
+        if (GetLastError() != ERROR_IO_INCOMPLETE) {
+            stop();  // Directory gone or watching failed, nothing more will come
+        }
+        return false;
+    }
+    
+    // No bytes: the changes didn't fit in the buffer and were dropped
+    bool overflowed = bytes == 0;
+    
+    const char* entry = (const char*)buffer;
+    while (!overflowed) {
+        const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+        if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME && hasSuffix(info)) {
+            AllocTracker::restartWarmup();  // The name and the reload that follows allocate
+            
+            // Screen file names are plain ASCII
+            std::string name;
+            for (DWORD i = 0; i < info->FileNameLength / sizeof(WCHAR); i++) {
+                WCHAR ch = info->FileName[i];
+                name += (ch < 128) ? (char)ch : '?';
+            }
+            if (std::find(changedFiles.begin(), changedFiles.end(), name) == changedFiles.end()) {
+                changedFiles.push_back(name);
+            }
+        }
+        if (info->NextEntryOffset == 0) break;
+        entry += info->NextEntryOffset;
+    }
+    
+    if (!requestChanges()) {
+        watching = false;
+        stop();
+    }
+    return overflowed;
+}
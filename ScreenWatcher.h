@@ -0,0 +1,40 @@
+#pragma once
+#include "GameConfig.h"
+#include <vector>
+#include <string>
+
+// Reports files of one directory that were written, created or renamed into
+// it, through ReadDirectoryChangesW. One overlapped read is always pending, poll()
+// only checks whether it completed, so it never waits and costs nothing
+// while nobody edits files. Only names ending in the given suffix are
+// reported; files the game writes itself (telemetry, saves) are skipped
+// without building their names.
+class ScreenWatcher {
+private:
+    HANDLE directory;
+    HANDLE changedEvent;
+    OVERLAPPED overlapped;
+    DWORD buffer[2048];  // Notifications must be DWORD aligned
+    std::string suffix;
+    bool watching;
+    
+    bool requestChanges();
+    bool hasSuffix(const FILE_NOTIFY_INFORMATION* info) const;
+    
+public:
+    ScreenWatcher();
+    ~ScreenWatcher();
+    
+    // Prevent copying (owns the handles and the pending read)
+    ScreenWatcher(const ScreenWatcher&) = delete;
+    ScreenWatcher& operator=(const ScreenWatcher&) = delete;
+    
+    bool start(const std::string& directoryPath, const std::string& nameSuffix);
+    void stop();
+    bool isWatching() const { return watching; }
+    
+    // Appends the names changed since the last call (each name once).
+    // Returns true if too many changes came in to list them, the caller
+    // should then check all of its files.
+    bool poll(std::vector<std::string>& changedFiles);
+};
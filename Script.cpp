@@ -0,0 +1,358 @@
+#include "Script.h"
+#include <sstream>
+#include <cctype>
+
+namespace {
+
+struct Token {
+    enum class Kind { WORD, NUMBER, STRING, SYMBOL };
+    Kind kind;
+    std::string text;  // Word, string contents or symbol
+    int number;
+};
+
+// Splits one line into tokens, stops at a # outside a string
+void tokenize(const std::string& line, std::vector<Token>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        char ch = line[i];
+        if (std::isspace((unsigned char)ch)) {
+            i++;
+        } else if (ch == '#') {
+            break;
+        } else if (std::isalpha((unsigned char)ch) || ch == '_') {
+            size_t start = i;
+            while (i < line.size() && (std::isalnum((unsigned char)line[i]) || line[i] == '_')) i++;
+            tokens.push_back({ Token::Kind::WORD, line.substr(start, i - start), 0 });
+        } else if (std::isdigit((unsigned char)ch)) {
+            int value = 0;
+            while (i < line.size() && std::isdigit((unsigned char)line[i])) {
+                value = value * 10 + (line[i] - '0');
+                if (value > 1000000) throw "number too large";
+                i++;
+            }
+            tokens.push_back({ Token::Kind::NUMBER, "", value });
+        } else if (ch == '\'') {
+            if (i + 2 >= line.size() || line[i + 2] != '\'') throw "a char is written 'c'";
+            tokens.push_back({ Token::Kind::NUMBER, "", (unsigned char)line[i + 1] });
+            i += 3;
+        } else if (ch == '"') {
+            size_t end = line.find('"', i + 1);
+            if (end == std::string::npos) throw "string without closing quote";
+            tokens.push_back({ Token::Kind::STRING, line.substr(i + 1, end - i - 1), 0 });
+            i = end + 1;
+        } else {
+            // Two-char comparisons first
+            std::string symbol(1, ch);
+            if (i + 1 < line.size() && line[i + 1] == '=' && (ch == '=' || ch == '!' || ch == '<' || ch == '>')) {
+                symbol += '=';
+            }
+            if (symbol != "+" && symbol != "-" && symbol != "<" && symbol != ">" &&
+                symbol != "==" && symbol != "!=" && symbol != "<=" && symbol != ">=") {
+                throw "unexpected character";
+            }
+            tokens.push_back({ Token::Kind::SYMBOL, symbol, 0 });
+            i += symbol.size();
+        }
+    }
+}
+
+bool isKeyword(const std::string& word) {
+    static const char* const KEYWORDS[] = {
+        "on", "end", "set", "if", "else", "while", "score", "lives", "open", "arm",
+        "say", "ask", "goto", "stop", "player", "x", "y", "value", "tick"
+    };
+    for (const char* keyword : KEYWORDS) {
+        if (word == keyword) return true;
+    }
+    return false;
+}
+
+class ScriptCompiler {
+private:
+    struct Block {
+        enum class Kind { HANDLER, IF, ELSE, WHILE };
+        Kind kind;
+        int jump;       // Instruction whose target is patched at the end of the block
+        int loopStart;  // WHILE: where the condition is checked
+    };
+    
+    ScriptProgram& program;
+    std::vector<Token> tokens;
+    size_t pos;
+    int nextTemp;
+    std::vector<Block> blocks;
+    
+    bool atEnd() const { return pos >= tokens.size(); }
+    
+    const Token& next() {
+        if (atEnd()) throw "line ends too early";
+        return tokens[pos++];
+    }
+    
+    bool nextIsSymbol(const char* symbol) const {
+        return !atEnd() && tokens[pos].kind == Token::Kind::SYMBOL && tokens[pos].text == symbol;
+    }
+    
+    void expectEnd() const {
+        if (!atEnd()) throw "unexpected words at the end of the line";
+    }
+    
+    int readNumber() {
+        bool negative = nextIsSymbol("-");
+        if (negative) pos++;
+        const Token& token = next();
+        if (token.kind != Token::Kind::NUMBER) throw "number expected";
+        return negative ? -token.number : token.number;
+    }
+    
+    int emit(ScriptOp op, int a = 0, int b = 0, int c = 0, int k = 0) {
+        program.code.push_back({ op, (uint8_t)a, (uint8_t)b, (uint8_t)c, k });
+        return (int)program.code.size() - 1;
+    }
+    
+    void patchJump(int instruction) {
+        program.code[instruction].k = (int)program.code.size();
+    }
+    
+    int newTemp() {
+        if (nextTemp >= SCRIPT_LOCAL_REGISTERS) throw "expression too long";
+        return nextTemp++;
+    }
+    
+    bool isTemp(int reg) const {
+        return reg > SCRIPT_REG_VALUE && reg < SCRIPT_LOCAL_REGISTERS;
+    }
+    
+    int getVariable(const std::string& name) {
+        for (int i = 0; i < (int)program.variables.size(); i++) {
+            if (program.variables[i] == name) return SCRIPT_LOCAL_REGISTERS + i;
+        }
+        if ((int)program.variables.size() >= SCRIPT_MAX_VARIABLES) throw "too many variables";
+        program.variables.push_back(name);
+        return SCRIPT_LOCAL_REGISTERS + (int)program.variables.size() - 1;
+    }
+    
+    // Register holding the term, event values and variables are used in place
+    int compileTerm() {
+        if (atEnd()) throw "value expected";
+        if (nextIsSymbol("-") || tokens[pos].kind == Token::Kind::NUMBER) {
+            int temp = newTemp();
+            emit(ScriptOp::LOADK, temp, 0, 0, readNumber());
+            return temp;
+        }
+        
+        const Token& token = next();
+        if (token.kind != Token::Kind::WORD) throw "value expected";
+        if (token.text == "player") return SCRIPT_REG_PLAYER;
+        if (token.text == "x") return SCRIPT_REG_X;
+        if (token.text == "y") return SCRIPT_REG_Y;
+        if (token.text == "value") return SCRIPT_REG_VALUE;
+        
+        ScriptValue value;
+        if (token.text == "tick") {
+            value = ScriptValue::TICK;
+        } else if (token.text == "score") {
+            value = ScriptValue::SCORE;
+        } else if (token.text == "lives") {
+            value = ScriptValue::LIVES;
+        } else {
+            if (isKeyword(token.text)) throw "keyword used as a value";
+            return getVariable(token.text);
+        }
+        int temp = newTemp();
+        emit(ScriptOp::GET, temp, 0, 0, (int)value);
+        return temp;
+    }
+    
+    int compileExpression() {
+        int left = compileTerm();
+        while (nextIsSymbol("+") || nextIsSymbol("-")) {
+            ScriptOp op = tokens[pos++].text == "+" ? ScriptOp::ADD : ScriptOp::SUB;
+            int right = compileTerm();
+            int target = isTemp(left) ? left : (isTemp(right) ? right : newTemp());
+            emit(op, target, left, right);
+            if (isTemp(right) && right != target && right == nextTemp - 1) nextTemp--;
+            left = target;
+        }
+        return left;
+    }
+    
+    // Register holding 1 if the comparison holds, 0 otherwise
+    int compileCondition() {
+        int left = compileExpression();
+        const Token& symbol = next();
+        if (symbol.kind != Token::Kind::SYMBOL || symbol.text == "+" || symbol.text == "-") {
+            throw "comparison expected (== != < <= > >=)";
+        }
+        int right = compileExpression();
+        int target = newTemp();
+        
+        // a > b is b < a
+        if (symbol.text == "<") emit(ScriptOp::LT, target, left, right);
+        else if (symbol.text == "<=") emit(ScriptOp::LE, target, left, right);
+        else if (symbol.text == ">") emit(ScriptOp::LT, target, right, left);
+        else if (symbol.text == ">=") emit(ScriptOp::LE, target, right, left);
+        else if (symbol.text == "==") emit(ScriptOp::EQ, target, left, right);
+        else emit(ScriptOp::NE, target, left, right);
+        return target;
+    }
+    
+    int addString(const std::string& text) {
+        program.strings.push_back(text);
+        return (int)program.strings.size() - 1;
+    }
+    
+    void compileHandler() {
+        if (!blocks.empty()) throw "handler inside a handler (missing end?)";
+        
+        const Token& name = next();
+        ScriptHandler handler = { ScriptEvent::START, -1, -1, -1, (int)program.code.size() };
+        if (name.text == "start") {
+            handler.event = ScriptEvent::START;
+        } else if (name.text == "tick") {
+            handler.event = ScriptEvent::TICK;
+        } else if (name.text == "enter") {
+            handler.event = ScriptEvent::ENTER;
+            handler.filterX = readNumber();
+            handler.filterY = readNumber();
+        } else if (name.text == "pickup" || name.text == "switch" || name.text == "door") {
+            handler.event = name.text == "pickup" ? ScriptEvent::PICKUP :
+                            name.text == "switch" ? ScriptEvent::SWITCH : ScriptEvent::DOOR;
+            if (!atEnd()) handler.filterValue = readNumber();
+        } else if (name.text == "bomb" || name.text == "riddle") {
+            handler.event = name.text == "bomb" ? ScriptEvent::BOMB : ScriptEvent::RIDDLE;
+            if (!atEnd()) {
+                handler.filterX = readNumber();
+                handler.filterY = readNumber();
+            }
+        } else if (name.text == "solved") {
+            handler.event = ScriptEvent::SOLVED;
+        } else if (name.text == "failed") {
+            handler.event = ScriptEvent::FAILED;
+        } else {
+            throw "unknown event";
+        }
+        expectEnd();
+        
+        program.handlers.push_back(handler);
+        blocks.push_back({ Block::Kind::HANDLER, -1, -1 });
+    }
+    
+    void compileEnd() {
+        if (blocks.empty()) throw "end without a block";
+        Block block = blocks.back();
+        blocks.pop_back();
+        
+        switch (block.kind) {
+            case Block::Kind::HANDLER:
+                emit(ScriptOp::HALT);
+                break;
+            case Block::Kind::IF:
+            case Block::Kind::ELSE:
+                patchJump(block.jump);
+                break;
+            case Block::Kind::WHILE:
+                emit(ScriptOp::JUMP, 0, 0, 0, block.loopStart);
+                patchJump(block.jump);
+                break;
+        }
+    }
+    
+    void compileStatement() {
+        const Token& keyword = next();
+        if (keyword.kind != Token::Kind::WORD) throw "statement expected";
+        const std::string& word = keyword.text;
+        
+        if (word == "on") {
+            compileHandler();
+            return;
+        }
+        if (blocks.empty()) throw "statement outside a handler";
+        
+        if (word == "end") {
+            expectEnd();
+            compileEnd();
+        } else if (word == "set") {
+            const Token& name = next();
+            if (name.kind != Token::Kind::WORD || isKeyword(name.text)) throw "variable name expected";
+            int variable = getVariable(name.text);
+            int value = compileExpression();
+            emit(ScriptOp::MOVE, variable, value);
+        } else if (word == "if") {
+            int condition = compileCondition();
+            blocks.push_back({ Block::Kind::IF, emit(ScriptOp::JUMPIFNOT, condition), -1 });
+        } else if (word == "else") {
+            if (blocks.back().kind != Block::Kind::IF) throw "else without if";
+            int skipElse = emit(ScriptOp::JUMP);
+            patchJump(blocks.back().jump);
+            blocks.back() = { Block::Kind::ELSE, skipElse, -1 };
+        } else if (word == "while") {
+            int loopStart = (int)program.code.size();
+            int condition = compileCondition();
+            blocks.push_back({ Block::Kind::WHILE, emit(ScriptOp::JUMPIFNOT, condition), loopStart });
+        } else if (word == "score" || word == "lives" || word == "goto") {
+            ScriptOp op = word == "score" ? ScriptOp::SCORE : word == "lives" ? ScriptOp::LIVES : ScriptOp::GOTO;
+            emit(op, compileExpression());
+        } else if (word == "open" || word == "arm") {
+            int x = compileExpression();
+            int y = compileExpression();
+            emit(word == "open" ? ScriptOp::OPEN : ScriptOp::ARM, x, y);
+        } else if (word == "say") {
+            const Token& text = next();
+            if (text.kind != Token::Kind::STRING) throw "\"text\" expected";
+            emit(ScriptOp::SAY, 0, 0, 0, addString(text.text));
+        } else if (word == "ask") {
+            const Token& text = next();
+            if (text.kind != Token::Kind::STRING) throw "\"question\" expected";
+            int answer = compileExpression();
+            emit(ScriptOp::ASK, answer, 0, 0, addString(text.text));
+        } else if (word == "stop") {
+            emit(ScriptOp::HALT);
+        } else {
+            throw "unknown statement";
+        }
+        expectEnd();
+    }
+    
+public:
+    explicit ScriptCompiler(ScriptProgram& target) : program(target), pos(0), nextTemp(0) {}
+    
+    void compileLine(const std::string& line) {
+        tokenize(line, tokens);
+        pos = 0;
+        nextTemp = SCRIPT_REG_VALUE + 1;  // Temporaries only live for one statement
+        if (!tokens.empty()) {
+            compileStatement();
+        }
+    }
+    
+    void finish() const {
+        if (!blocks.empty()) throw "missing end";
+    }
+};
+
+}  // namespace
+
+bool ScriptProgram::compile(const std::string& source, std::string& error) {
+    *this = ScriptProgram();
+    ScriptCompiler compiler(*this);
+    
+    std::istringstream lines(source);
+    std::string line;
+    int lineNumber = 0;
+    try {
+        while (std::getline(lines, line)) {
+            lineNumber++;
+            compiler.compileLine(line);
+        }
+        lineNumber++;
+        compiler.finish();
+    } catch (const char* reason) {
+        error = "line " + std::to_string(lineNumber) + ": " + reason;
+        *this = ScriptProgram();
+        return false;
+    }
+    return true;
+}
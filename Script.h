@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Room scripts: adv-world_NN.script next to adv-world_NN.screen (optional).
+// Handlers run when something happens in that room:
+//   on start               the game starts
+//   on tick                every game cycle
+//   on enter <x> <y>       a player steps onto the cell
+//   on pickup ['c']        a player picks up an item (value = its char)
+//   on bomb [<x> <y>]      a bomb goes off
+//   on switch [<group>]    a switch is toggled (value = 1 on, 0 off)
+//   on door [<digit>]      a player opens a door with a key (value = digit)
+//   on riddle [<x> <y>]    a player reaches a riddle
+//   on solved / on failed  the riddle was answered
+// followed by statements and "end":
+//   set <name> <expr>                 room variable (0 until set, kept all game)
+//   if <expr> <cmp> <expr> ... [else ...] end     cmp: == != < <= > >=
+//   while <expr> <cmp> <expr> ... end
+//   score <expr> / lives <expr>       add to the score / lives
+//   open <x> <y> / arm <x> <y>        remove a wall / activate a bomb
+//   say "text"                        message on the bottom line of the screen
+//   ask "question" <answer>           the riddle being shown, answered by one key
+//   goto <room>                       moves the player to that room (1 = first)
+//   stop                              leaves the handler
+// Expressions add and subtract numbers, 'c' chars, variables and player
+// (1 = first, 0 = none), x, y, value (of the event), tick, score, lives.
+// Coordinates are play-area coordinates, # starts a comment.
+enum class ScriptEvent : uint8_t {
+    START,
+    TICK,
+    ENTER,
+    PICKUP,
+    BOMB,
+    SWITCH,
+    DOOR,
+    RIDDLE,
+    SOLVED,
+    FAILED
+};
+
+enum class ScriptOp : uint8_t {
+    LOADK,      // r[a] = k
+    MOVE,       // r[a] = r[b]
+    ADD,        // r[a] = r[b] + r[c]
+    SUB,        // r[a] = r[b] - r[c]
+    LT,         // r[a] = r[b] < r[c]
+    LE,         // r[a] = r[b] <= r[c]
+    EQ,         // r[a] = r[b] == r[c]
+    NE,         // r[a] = r[b] != r[c]
+    JUMP,       // pc = k
+    JUMPIFNOT,  // pc = k if r[a] is 0
+    GET,        // r[a] = game value k (ScriptValue)
+    HALT,
+    // Effects, carried out by the ScriptHost
+    SCORE,      // score += r[a]
+    LIVES,      // lives += r[a]
+    OPEN,       // wall at r[a], r[b]
+    ARM,        // bomb at r[a], r[b]
+    SAY,        // strings[k]
+    ASK,        // strings[k], answer r[a]
+    GOTO        // event player to room r[a]
+};
+
+enum class ScriptValue : uint8_t {
+    TICK,
+    SCORE,
+    LIVES
+};
+
+struct ScriptInstruction {
+    ScriptOp op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    int32_t k;
+};
+static_assert(sizeof(ScriptInstruction) == 8, "script instructions must stay 8 bytes");
+
+// Registers of a running handler: the event (player, x, y, value), then
+// temporaries, then the room's variables, which outlive the handler
+const int SCRIPT_REG_PLAYER = 0;
+const int SCRIPT_REG_X = 1;
+const int SCRIPT_REG_Y = 2;
+const int SCRIPT_REG_VALUE = 3;
+const int SCRIPT_LOCAL_REGISTERS = 16;
+const int SCRIPT_MAX_VARIABLES = 256 - SCRIPT_LOCAL_REGISTERS;
+
+struct ScriptHandler {
+    ScriptEvent event;
+    int filterX;      // Cell of ENTER, BOMB and RIDDLE, -1 = any
+    int filterY;
+    int filterValue;  // PICKUP char, SWITCH group, DOOR digit, -1 = any
+    int start;        // First instruction
+};
+
+// A room script compiled to register bytecode
+struct ScriptProgram {
+    std::vector<ScriptInstruction> code;
+    std::vector<ScriptHandler> handlers;
+    std::vector<std::string> strings;
+    std::vector<std::string> variables;  // Register SCRIPT_LOCAL_REGISTERS + index
+
+    bool isEmpty() const { return handlers.empty(); }
+
+    // Returns false with "line <n>: <reason>" in error if the source is invalid
+    bool compile(const std::string& source, std::string& error);
+};
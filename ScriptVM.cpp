@@ -0,0 +1,175 @@
+#include "ScriptVM.h"
+#include "GameConfig.h"
+
+ScriptVM::ScriptVM()
+    : pendingFirst(0), pendingCount(0), droppedCount(0), stoppedCount(0) {}
+
+void ScriptVM::clear() {
+    programs.clear();
+    variables.clear();
+    pendingFirst = 0;
+    pendingCount = 0;
+}
+
+void ScriptVM::setProgram(int room, ScriptProgram program) {
+    if (room >= (int)programs.size()) {
+        programs.resize(room + 1);
+        variables.resize(room + 1);
+    }
+    variables[room].assign(program.variables.size(), 0);
+    programs[room] = std::move(program);
+    pending.resize(SCRIPT_MAX_PENDING);
+}
+
+void ScriptVM::resetVariables() {
+    for (std::vector<int32_t>& roomVariables : variables) {
+        std::fill(roomVariables.begin(), roomVariables.end(), 0);
+    }
+    pendingFirst = 0;
+    pendingCount = 0;
+}
+
+void ScriptVM::writeState(StateWriter& out) const {
+    out.writeInt((int)variables.size());
+    for (const std::vector<int32_t>& roomVariables : variables) {
+        out.writeInt((int)roomVariables.size());
+        for (int32_t value : roomVariables) {
+            out.writeInt(value);
+        }
+    }
+    
+    out.writeInt(pendingCount);
+    for (int i = 0; i < pendingCount; i++) {
+        const Call& call = pending[(pendingFirst + i) % SCRIPT_MAX_PENDING];
+        out.writeInt(call.room);
+        out.writeInt(call.pc);
+        out.writeInt(call.executed);
+        for (int32_t value : call.registers) {
+            out.writeInt(value);
+        }
+    }
+}
+
+bool ScriptVM::readState(StateReader& in) {
+    if (in.readInt() != (int)variables.size()) {
+        in.fail();
+    }
+    for (size_t room = 0; room < variables.size() && !in.hasFailed(); room++) {
+        if (in.readInt() != (int)variables[room].size()) {
+            in.fail();
+            break;
+        }
+        for (int32_t& value : variables[room]) {
+            value = in.readInt();
+        }
+    }
+    
+    // Restored calls start at the front of the ring
+    int count = in.readInt();
+    if (count < 0 || count > (int)pending.size()) {
+        in.fail();
+    }
+    pendingFirst = 0;
+    pendingCount = 0;
+    for (int i = 0; i < count && !in.hasFailed(); i++) {
+        Call& call = pending[i];
+        call.room = in.readInt();
+        call.pc = in.readInt();
+        call.executed = in.readInt();
+        for (int32_t& value : call.registers) {
+            value = in.readInt();
+        }
+        if (call.room < 0 || call.room >= (int)programs.size() ||
+            call.pc < 0 || call.pc >= (int)programs[call.room].code.size()) {
+            in.fail();
+            break;
+        }
+        pendingCount++;
+    }
+    return !in.hasFailed();
+}
+
+bool ScriptVM::hasScripts() const {
+    for (const ScriptProgram& program : programs) {
+        if (!program.isEmpty()) return true;
+    }
+    return false;
+}
+
+void ScriptVM::post(int room, ScriptEvent event, int player, Point pos, int value) {
+    if (room < 0 || room >= (int)programs.size()) return;
+    
+    for (const ScriptHandler& handler : programs[room].handlers) {
+        if (handler.event != event) continue;
+        if (handler.filterX >= 0 && (handler.filterX != pos.getX() || handler.filterY != pos.getY())) continue;
+        if (handler.filterValue >= 0 && handler.filterValue != value) continue;
+        
+        if (pendingCount >= SCRIPT_MAX_PENDING) {
+            droppedCount++;
+            continue;
+        }
+        Call& call = pending[(pendingFirst + pendingCount++) % SCRIPT_MAX_PENDING];
+        call = Call();
+        call.room = room;
+        call.pc = handler.start;
+        call.registers[SCRIPT_REG_PLAYER] = player + 1;
+        call.registers[SCRIPT_REG_X] = pos.getX();
+        call.registers[SCRIPT_REG_Y] = pos.getY();
+        call.registers[SCRIPT_REG_VALUE] = value;
+    }
+}
+
+int ScriptVM::run(ScriptHost& host, int budget) {
+    int executed = 0;
+    while (pendingCount > 0 && executed < budget) {
+        Call& call = pending[pendingFirst];
+        const ScriptProgram& program = programs[call.room];
+        const ScriptInstruction* code = program.code.data();
+        int32_t* locals = call.registers;
+        int32_t* globals = variables[call.room].data() - SCRIPT_LOCAL_REGISTERS;
+        auto reg = [&](int r) -> int32_t& { return r < SCRIPT_LOCAL_REGISTERS ? locals[r] : globals[r]; };
+        
+        bool finished = false;
+        while (!finished && executed < budget) {
+            const ScriptInstruction& in = code[call.pc++];
+            executed++;
+            
+            switch (in.op) {
+                case ScriptOp::LOADK: reg(in.a) = in.k; break;
+                case ScriptOp::MOVE: reg(in.a) = reg(in.b); break;
+                case ScriptOp::ADD: reg(in.a) = reg(in.b) + reg(in.c); break;
+                case ScriptOp::SUB: reg(in.a) = reg(in.b) - reg(in.c); break;
+                case ScriptOp::LT: reg(in.a) = reg(in.b) < reg(in.c); break;
+                case ScriptOp::LE: reg(in.a) = reg(in.b) <= reg(in.c); break;
+                case ScriptOp::EQ: reg(in.a) = reg(in.b) == reg(in.c); break;
+                case ScriptOp::NE: reg(in.a) = reg(in.b) != reg(in.c); break;
+                case ScriptOp::JUMP: call.pc = in.k; break;
+                case ScriptOp::JUMPIFNOT:
+                    if (!reg(in.a)) call.pc = in.k;
+                    break;
+                case ScriptOp::GET: reg(in.a) = host.getScriptValue((ScriptValue)in.k); break;
+                case ScriptOp::HALT: finished = true; break;
+                
+                case ScriptOp::SAY:
+                case ScriptOp::ASK:
+                    host.runScriptEffect(in.op, call.room, locals[SCRIPT_REG_PLAYER] - 1, reg(in.a), 0,
+                                         program.strings[in.k]);
+                    break;
+                default:
+                    host.runScriptEffect(in.op, call.room, locals[SCRIPT_REG_PLAYER] - 1, reg(in.a), reg(in.b),
+                                         std::string());
+                    break;
+            }
+            
+            if (++call.executed >= SCRIPT_CALL_LIMIT && !finished) {
+                stoppedCount++;  // Most likely an endless loop
+                finished = true;
+            }
+        }
+        
+        if (!finished) break;  // Out of budget, the call goes on next cycle
+        pendingFirst = (pendingFirst + 1) % SCRIPT_MAX_PENDING;
+        pendingCount--;
+    }
+    return executed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Script.h"
+#include "Point.h"
+#include "SaveFile.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// What scripts can read and change in the game
+class ScriptHost {
+public:
+    virtual ~ScriptHost() {}
+    
+    virtual int getScriptValue(ScriptValue value) = 0;
+    // op is one of the effect ops, a and b its register values, text its string (or empty)
+    virtual void runScriptEffect(ScriptOp op, int room, int player, int a, int b, const std::string& text) = 0;
+};
+
+// Runs the room scripts. Events queue the handlers they match, run()
+// executes queued handlers in order until the cycle's instruction budget is
+// used up. A handler that is cut off continues where it stopped next cycle,
+// so a slow script delays its own effects but never the game cycle.
+class ScriptVM {
+private:
+    struct Call {
+        int room;
+        int pc;
+        int executed;
+        int32_t registers[SCRIPT_LOCAL_REGISTERS];
+    };
+    
+    std::vector<ScriptProgram> programs;          // Per room, empty = no script
+    std::vector<std::vector<int32_t>> variables;  // Per room
+    std::vector<Call> pending;  // Ring of SCRIPT_MAX_PENDING calls, allocated with the first script
+    int pendingFirst;
+    int pendingCount;
+    int droppedCount;   // Events that found the queue full
+    int stoppedCount;   // Handlers stopped at SCRIPT_CALL_LIMIT
+    
+public:
+    ScriptVM();
+    
+    void clear();  // No rooms, no scripts
+    void setProgram(int room, ScriptProgram program);
+    void resetVariables();  // All 0, queued handlers are dropped
+    
+    // Variables and queued handlers, part of the game state (saves and rewind)
+    void writeState(StateWriter& out) const;
+    bool readState(StateReader& in);  // Fails if the scripts don't match the ones written
+    // Values a full handler queue adds to the state
+    static int getQueueStateLimit() { return SCRIPT_MAX_PENDING * (3 + SCRIPT_LOCAL_REGISTERS); }
+    
+    bool hasScripts() const;
+    
+    // Queues every handler of the room's script that matches the event.
+    // player is an index (-1 = none), value the event's value or filter.
+    void post(int room, ScriptEvent event, int player, Point pos, int value);
+    
+    // Returns the number of instructions executed
+    int run(ScriptHost& host, int budget);
+    
+    int getPendingCount() const { return pendingCount; }
+    int getDroppedCount() const { return droppedCount; }
+    int getStoppedCount() const { return stoppedCount; }
+};
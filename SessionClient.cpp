@@ -0,0 +1,109 @@
+#include "SessionClient.h"
+#include "SessionProtocol.h"
+#include "GameConfig.h"
+#include <winsock2.h>
+#include <afunix.h>
+#include <conio.h>
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// Draws the changed runs at their place on the console
+static void drawRuns(const std::vector<char>& frame, int width, const std::vector<FrameRun>& runs) {
+    for (const FrameRun& run : runs) {
+        gotoxy(run.column, run.row);
+        std::cout.write(frame.data() + run.row * width + run.column, run.length);
+    }
+    std::cout.flush();
+}
+
+static void showResult(bool won, int score) {
+    clearScreen();
+    gotoxy(30, 11);
+    std::cout << (won ? "CONGRATULATIONS! YOU WON!" : "GAME OVER");
+    gotoxy(30, 12);
+    std::cout << "Final Score: " << score;
+    std::cout.flush();
+    Sleep(3000);
+}
+
+int runSessionClient(const std::string& socketPath) {
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return 1;
+    
+    SOCKADDR_UN address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    
+    SOCKET server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server == INVALID_SOCKET || connect(server, (SOCKADDR*)&address, sizeof(address)) == SOCKET_ERROR) {
+        std::cerr << "Error: no game server on " << socketPath << std::endl;
+        if (server != INVALID_SOCKET) closesocket(server);
+        WSACleanup();
+        return 1;
+    }
+    
+    // Same size as the server's FrameBuffer
+    const int width = SCREEN_WIDTH;
+    const int height = SCREEN_HEIGHT + SCREEN_OFFSET_Y;
+    std::vector<char> frame(width * height, ' ');
+    std::vector<FrameRun> runs;
+    std::vector<char> received;
+    
+    hideCursor();
+    clearScreen();
+    
+    bool running = true;
+    while (running) {
+        while (_kbhit()) {
+            char key = (char)_getch();
+            if (key == Keys::ESC) {
+                running = false;
+                break;
+            }
+            send(server, &key, 1, 0);
+        }
+        if (!running) break;
+        
+        WSAPOLLFD fd = {};
+        fd.fd = server;
+        fd.events = POLLRDNORM;
+        if (WSAPoll(&fd, 1, 10) <= 0) continue;
+        
+        char buffer[4096];
+        int count = recv(server, buffer, sizeof(buffer), 0);
+        if (count <= 0) break;  // Server went away
+        received.insert(received.end(), buffer, buffer + count);
+        
+        // Handle every message that has fully arrived
+        size_t offset = 0;
+        size_t size;
+        while ((size = getMessageSize(received.data() + offset, received.size() - offset)) > 0) {
+            const char* message = received.data() + offset;
+            const char* payload = message + SessionMessage::HEADER_SIZE;
+            size_t payloadSize = size - SessionMessage::HEADER_SIZE;
+            offset += size;
+            
+            if (message[2] == SessionMessage::FRAME) {
+                if (!applyFrameDelta(payload, payloadSize, frame.data(), width, height, runs)) {
+                    running = false;
+                    break;
+                }
+                drawRuns(frame, width, runs);
+            } else if (message[2] == SessionMessage::OVER && payloadSize >= 1 + sizeof(int32_t)) {
+                int32_t score;
+                std::memcpy(&score, payload + 1, sizeof(score));
+                showResult(payload[0] != 0, score);
+                running = false;
+                break;
+            }
+        }
+        received.erase(received.begin(), received.begin() + offset);
+    }
+    
+    closesocket(server);
+    WSACleanup();
+    clearScreen();
+    return 0;
+}
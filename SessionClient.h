@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// Thin client for SessionServer: sends the keys typed and draws the screen
+// changes it gets back. ESC leaves. Returns the process exit code.
+int runSessionClient(const std::string& socketPath);
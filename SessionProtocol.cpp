@@ -0,0 +1,93 @@
+#include "SessionProtocol.h"
+#include "GameConfig.h"
+#include <cstdint>
+#include <cstring>
+
+static void appendHeader(std::vector<char>& out, size_t payloadSize, char type) {
+    out.push_back((char)(payloadSize & 0xFF));
+    out.push_back((char)((payloadSize >> 8) & 0xFF));
+    out.push_back(type);
+}
+
+void appendFrameDelta(const char* previous, const char* current, int width, int height,
+                      std::vector<char>& out) {
+    size_t start = out.size();
+    appendHeader(out, 0, SessionMessage::FRAME);  // Length filled in below
+    
+    for (int row = 0; row < height; row++) {
+        const char* before = previous + row * width;
+        const char* after = current + row * width;
+        
+        int x = 0;
+        while (x < width) {
+            if (before[x] == after[x]) {
+                x++;
+                continue;
+            }
+            
+            // Extend the run over changed cells and short unchanged gaps
+            int runStart = x;
+            int runEnd = x + 1;
+            int gap = 0;
+            for (int next = runEnd; next < width && gap <= SESSION_RUN_MERGE_GAP; next++) {
+                if (before[next] != after[next]) {
+                    runEnd = next + 1;
+                    gap = 0;
+                } else {
+                    gap++;
+                }
+            }
+            
+            out.push_back((char)row);
+            out.push_back((char)runStart);
+            out.push_back((char)(runEnd - runStart));
+            out.insert(out.end(), after + runStart, after + runEnd);
+            x = runEnd;
+        }
+    }
+    
+    size_t payloadSize = out.size() - start - SessionMessage::HEADER_SIZE;
+    if (payloadSize == 0) {
+        out.resize(start);  // Nothing changed
+        return;
+    }
+    out[start] = (char)(payloadSize & 0xFF);
+    out[start + 1] = (char)((payloadSize >> 8) & 0xFF);
+}
+
+void appendGameOver(bool won, int score, std::vector<char>& out) {
+    int32_t value = score;
+    appendHeader(out, 1 + sizeof(value), SessionMessage::OVER);
+    out.push_back(won ? 1 : 0);
+    const char* bytes = (const char*)&value;
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+bool applyFrameDelta(const char* payload, size_t size, char* frame, int width, int height,
+                     std::vector<FrameRun>& runs) {
+    runs.clear();
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < 3) return false;
+        FrameRun run;
+        run.row = (unsigned char)payload[offset];
+        run.column = (unsigned char)payload[offset + 1];
+        run.length = (unsigned char)payload[offset + 2];
+        offset += 3;
+        
+        if (run.row >= height || run.column + run.length > width || size - offset < (size_t)run.length) {
+            return false;
+        }
+        std::memcpy(frame + run.row * width + run.column, payload + offset, run.length);
+        offset += run.length;
+        runs.push_back(run);
+    }
+    return true;
+}
+
+size_t getMessageSize(const char* data, size_t available) {
+    if (available < (size_t)SessionMessage::HEADER_SIZE) return 0;
+    size_t payloadSize = (unsigned char)data[0] | ((size_t)(unsigned char)data[1] << 8);
+    size_t total = SessionMessage::HEADER_SIZE + payloadSize;
+    return available >= total ? total : 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// What the session server and its clients say to each other.
+// Clients send plain key bytes. The server sends messages:
+//   length (uint16, of what follows the header), type (char), payload
+//   FRAME: changed runs of cells, each run is row, column, count (a byte
+//          each) followed by count chars
+//   OVER:  the game ended, payload is won (a byte) and the score (int32)
+namespace SessionMessage {
+    const char FRAME = 'F';
+    const char OVER = 'O';
+    const int HEADER_SIZE = 3;
+}
+
+// Part of a row that changed
+struct FrameRun {
+    int row;
+    int column;
+    int length;
+};
+
+// Appends a FRAME message that turns previous into current (width x height
+// chars, row by row), or nothing if they're the same. Nearby changes are
+// merged into one run when that is shorter than starting a new one.
+void appendFrameDelta(const char* previous, const char* current, int width, int height,
+                      std::vector<char>& out);
+void appendGameOver(bool won, int score, std::vector<char>& out);
+
+// Applies a FRAME payload to frame and lists the runs it changed.
+// Returns false if the payload is malformed (frame may be partly updated).
+bool applyFrameDelta(const char* payload, size_t size, char* frame, int width, int height,
+                     std::vector<FrameRun>& runs);
+
+// Size of the first message in data if it has fully arrived, 0 otherwise
+size_t getMessageSize(const char* data, size_t available);
@@ -0,0 +1,267 @@
+#include "SessionServer.h"
+#include "SessionProtocol.h"
+#include "Game.h"
+#include "LevelGenerator.h"
+#include <afunix.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+SessionServer::SessionServer() : listener(INVALID_SOCKET), started(false), playerCount(DEFAULT_PLAYER_COUNT) {}
+
+SessionServer::~SessionServer() {
+    stop();
+}
+
+// Same files, same order as Game::loadRoomsFromFiles
+bool SessionServer::loadLevels() {
+    levels.tables.clear();
+    for (int i = 1; i <= 99; i++) {
+        std::ostringstream filename;
+        filename << "adv-world_" << (i < 10 ? "0" : "") << i << ".screen";
+        
+        std::ifstream file(filename.str());
+        if (!file.good()) continue;
+        
+        std::stringstream text;
+        text << file.rdbuf();
+        try {
+            levels.tables.push_back(parseLevel(text.str().c_str()));
+        } catch (const char* reason) {
+            std::cerr << "Skipping " << filename.str() << ": " << reason << std::endl;
+        }
+    }
+    
+    if (levels.tables.empty()) {
+        std::cerr << "Error: No screen files found (adv-world*.screen)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SessionServer::start(const std::string& path, int generatedRooms, uint32_t seed, int players) {
+    if (started) return true;
+    playerCount = players;
+    if (generatedRooms > 0) {
+        LevelGenerator generator(seed, playerCount);
+        levels.tables = generator.generateTables(generatedRooms);
+    } else if (!loadLevels()) {
+        return false;
+    }
+    levels.buildLayouts();
+    
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
+    started = true;
+    
+    SOCKADDR_UN address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: socket path too long" << std::endl;
+        stop();
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    
+    DeleteFileA(path.c_str());  // Left over by a server that didn't shut down
+    
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET ||
+        bind(listener, (SOCKADDR*)&address, sizeof(address)) == SOCKET_ERROR ||
+        listen(listener, SOMAXCONN) == SOCKET_ERROR) {
+        std::cerr << "Error: can't listen on " << path << std::endl;
+        stop();
+        return false;
+    }
+    socketPath = path;
+    
+    u_long nonBlocking = 1;
+    ioctlsocket(listener, FIONBIO, &nonBlocking);
+    return true;
+}
+
+void SessionServer::stop() {
+    for (auto& session : sessions) {
+        closesocket(session->socket);
+    }
+    sessions.clear();
+    
+    if (listener != INVALID_SOCKET) {
+        closesocket(listener);
+        listener = INVALID_SOCKET;
+        DeleteFileA(socketPath.c_str());
+    }
+    if (started) {
+        WSACleanup();
+        started = false;
+    }
+}
+
+void SessionServer::acceptClients() {
+    while (true) {
+        SOCKET client = accept(listener, nullptr, nullptr);
+        if (client == INVALID_SOCKET) return;  // No one else waiting
+        
+        u_long nonBlocking = 1;
+        ioctlsocket(client, FIONBIO, &nonBlocking);
+        
+        auto session = std::make_unique<Session>();
+        session->socket = client;
+        session->game = std::make_unique<Game>(playerCount, &levels);
+        session->game->startHeadless();
+        session->closing = false;
+        session->dropped = false;
+        
+        // Blank to start with, so the first delta is the whole screen
+        session->shownFrame.assign(frame.getWidth() * frame.getHeight(), ' ');
+        sessions.push_back(std::move(session));
+    }
+}
+
+void SessionServer::receiveKeys(Session& session) {
+    char buffer[256];
+    while (true) {
+        int received = recv(session.socket, buffer, sizeof(buffer), 0);
+        if (received == 0 || (received < 0 && WSAGetLastError() != WSAEWOULDBLOCK)) {
+            session.dropped = true;  // Client went away
+            return;
+        }
+        if (received < 0) return;  // Nothing more for now
+        
+        for (int i = 0; i < received; i++) {
+            // A client that floods keys loses the extra ones
+            if ((int)session.pendingKeys.size() < SESSION_MAX_PENDING_KEYS) {
+                session.pendingKeys += toUpperCase(buffer[i]);
+            }
+        }
+    }
+}
+
+void SessionServer::sendPending(Session& session) {
+    size_t sent = 0;
+    while (sent < session.outbox.size()) {
+        int count = send(session.socket, session.outbox.data() + sent,
+                         (int)(session.outbox.size() - sent), 0);
+        if (count < 0) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) session.dropped = true;
+            break;
+        }
+        sent += count;
+    }
+    session.outbox.erase(session.outbox.begin(), session.outbox.begin() + sent);
+    
+    if (session.closing && session.outbox.empty()) {
+        session.dropped = true;
+    }
+}
+
+void SessionServer::poll(int timeoutMillis) {
+    if (listener == INVALID_SOCKET) return;
+    
+    pollFds.clear();
+    WSAPOLLFD listenFd = {};
+    listenFd.fd = listener;
+    listenFd.events = POLLRDNORM;
+    pollFds.push_back(listenFd);
+    
+    for (const auto& session : sessions) {
+        WSAPOLLFD fd = {};
+        fd.fd = session->socket;
+        fd.events = POLLRDNORM;
+        if (!session->outbox.empty()) fd.events |= POLLWRNORM;
+        pollFds.push_back(fd);
+    }
+    
+    if (WSAPoll(pollFds.data(), (ULONG)pollFds.size(), timeoutMillis) <= 0) return;
+    
+    // Sessions line up with pollFds[1..], accepting new ones only appends
+    for (size_t i = 1; i < pollFds.size(); i++) {
+        Session& session = *sessions[i - 1];
+        if (pollFds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            session.dropped = true;
+            continue;
+        }
+        if (pollFds[i].revents & POLLRDNORM) receiveKeys(session);
+        if (pollFds[i].revents & POLLWRNORM) sendPending(session);
+    }
+    if (pollFds[0].revents & POLLRDNORM) acceptClients();
+    
+    removeDropped();
+}
+
+void SessionServer::tickSession(Session& session) {
+    Game& game = *session.game;
+    
+    // One key per cycle, like the console loop
+    if (!session.pendingKeys.empty()) {
+        char key = session.pendingKeys[0];
+        session.pendingKeys.erase(0, 1);
+        if (key == Keys::ESC) {
+            closeSession(session);  // There's no pause menu over the wire
+            return;
+        }
+        if (game.handleKey(key)) return;
+    }
+    
+    game.step();
+    game.composeFrame(frame);
+    
+    // While the client is still reading the last delta the frame only gets
+    // remembered as unsent, the next delta covers both
+    if (session.outbox.empty()) {
+        appendFrameDelta(session.shownFrame.data(), frame.getCells(),
+                         frame.getWidth(), frame.getHeight(), session.outbox);
+        std::memcpy(session.shownFrame.data(), frame.getCells(), session.shownFrame.size());
+    }
+    
+    if (game.isOver()) {
+        appendGameOver(game.hasWon(), game.getScore(), session.outbox);
+        session.closing = true;
+    }
+    sendPending(session);
+}
+
+void SessionServer::closeSession(Session& session) {
+    session.closing = true;
+    sendPending(session);
+}
+
+void SessionServer::tick() {
+    for (auto& session : sessions) {
+        if (!session->closing && !session->dropped) {
+            tickSession(*session);
+        }
+    }
+    removeDropped();
+}
+
+void SessionServer::removeDropped() {
+    for (size_t i = 0; i < sessions.size(); ) {
+        if (sessions[i]->dropped) {
+            closesocket(sessions[i]->socket);
+            sessions.erase(sessions.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void SessionServer::run() {
+    std::cout << "Serving " << levels.tables.size() << " rooms on " << socketPath << std::endl;
+    
+    DWORD nextTick = GetTickCount();
+    while (true) {
+        DWORD now = GetTickCount();
+        int wait = (int)(nextTick - now);
+        if (wait > 0) {
+            poll(wait);
+            continue;
+        }
+        
+        poll(0);
+        tick();
+        nextTick += GAME_CYCLE_DELAY;
+        if ((int)(nextTick - now) < 0) nextTick = now;  // Fell behind, don't try to catch up
+    }
+}
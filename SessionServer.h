@@ -0,0 +1,68 @@
+#pragma once
+#include "GameConfig.h"
+#include "SharedLevels.h"
+#include "FrameBuffer.h"
+#include <winsock2.h>
+#include <vector>
+#include <string>
+#include <memory>
+
+class Game;
+
+// Runs one headless Game per connected client, all on one thread.
+// Clients connect to a Unix domain socket (AF_UNIX, Windows 10 1803+), send
+// key bytes and get back only the screen cells that changed each cycle.
+// The levels are parsed once into read-only tables and wall layouts that
+// every session builds its rooms on, a session only holds what it can change. One WSAPoll over all sockets per cycle: nothing blocks, a
+// client that can't keep up just gets bigger deltas less often.
+class SessionServer {
+private:
+    struct Session {
+        SOCKET socket;
+        std::unique_ptr<Game> game;
+        std::vector<char> shownFrame;  // What the client has on screen
+        std::string pendingKeys;
+        std::vector<char> outbox;      // Bytes not yet taken by the socket
+        bool closing;                  // Drop once the outbox is sent
+        bool dropped;
+    };
+    
+    std::string socketPath;
+    SOCKET listener;
+    bool started;
+    int playerCount;  // Per game
+    SharedLevels levels;
+    FrameBuffer frame;  // Every session is composed into it in turn
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<WSAPOLLFD> pollFds;
+    
+    bool loadLevels();
+    void acceptClients();
+    void receiveKeys(Session& session);
+    void sendPending(Session& session);
+    void tickSession(Session& session);
+    void closeSession(Session& session);
+    void removeDropped();
+    
+public:
+    SessionServer();
+    ~SessionServer();
+    
+    // Prevent copying (owns the sockets)
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+    
+    // With generatedRooms > 0 the rooms come from LevelGenerator (seed) instead of the screen files
+    bool start(const std::string& path, int generatedRooms = 0, uint32_t seed = 1,
+               int players = DEFAULT_PLAYER_COUNT);
+    void stop();
+    
+    // Waits up to timeoutMillis for socket activity and handles it
+    void poll(int timeoutMillis);
+    // Advances every session one game cycle and sends the changes
+    void tick();
+    // poll + tick every GAME_CYCLE_DELAY, until the process is stopped
+    void run();
+    
+    int getSessionCount() const { return (int)sessions.size(); }
+};
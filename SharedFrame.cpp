@@ -0,0 +1,83 @@
+#include "SharedFrame.h"
+#include <cstring>
+
+SharedFramePublisher::SharedFramePublisher() : mapping(nullptr), data(nullptr) {
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                 0, sizeof(SharedFrameData), SPECTATOR_FRAME_NAME);
+    if (!mapping) return;
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Another game publishes already, two writers would break the seqlock
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+    
+    data = (SharedFrameData*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(SharedFrameData));
+    if (!data) return;
+    
+    // New mappings are zero filled, sequence 0 means no frame yet
+    data->width = SCREEN_WIDTH;
+    data->height = SCREEN_HEIGHT + SCREEN_OFFSET_Y;
+    std::memset(data->cells, ' ', sizeof(data->cells));
+    data->running.store(1, std::memory_order_release);
+}
+
+SharedFramePublisher::~SharedFramePublisher() {
+    if (data) {
+        data->running.store(0, std::memory_order_release);
+        UnmapViewOfFile(data);
+    }
+    if (mapping) CloseHandle(mapping);
+}
+
+void SharedFramePublisher::publish(const FrameBuffer& frame) {
+    if (!data) return;
+    
+    uint32_t sequence = data->sequence.load(std::memory_order_relaxed);
+    data->sequence.store(sequence + 1, std::memory_order_relaxed);  // Odd: writing
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data->cells, frame.getCells(), sizeof(data->cells));
+    data->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+SharedFrameReader::SharedFrameReader() : mapping(nullptr), data(nullptr), lastSequence(0) {}
+
+SharedFrameReader::~SharedFrameReader() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+}
+
+bool SharedFrameReader::open() {
+    if (data) return true;
+    
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, SPECTATOR_FRAME_NAME);
+    if (!mapping) return false;
+    
+    data = (const SharedFrameData*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(SharedFrameData));
+    if (!data) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    lastSequence = 0;
+    return true;
+}
+
+bool SharedFrameReader::readNewFrame(std::vector<char>& cells) {
+    if (!data) return false;
+    
+    cells.resize(sizeof(data->cells));
+    for (int attempt = 0; attempt < SPECTATOR_READ_TRIES; attempt++) {
+        uint32_t before = data->sequence.load(std::memory_order_acquire);
+        if (before == lastSequence) return false;  // Nothing new
+        if (before & 1) continue;                  // Being written
+        
+        std::memcpy(cells.data(), data->cells, sizeof(data->cells));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (data->sequence.load(std::memory_order_relaxed) == before) {
+            lastSequence = before;
+            return true;
+        }
+    }
+    return false;  // Try again next poll
+}
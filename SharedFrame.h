@@ -0,0 +1,62 @@
+#pragma once
+#include "GameConfig.h"
+#include "FrameBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Layout of the named shared memory a running game publishes its screen in.
+// Seqlock: the game bumps sequence to odd, copies the frame, bumps it to
+// even. Readers copy the frame and keep it only if sequence was the same even
+// number before and after. The game never waits for anybody, and writes one
+// frame whatever the number of spectators.
+struct SharedFrameData {
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> running;  // Cleared when the game exits
+    uint32_t width;
+    uint32_t height;
+    char cells[SCREEN_WIDTH * (SCREEN_HEIGHT + SCREEN_OFFSET_Y)];
+};
+
+// Game side, owns the mapping. Only the first game running publishes,
+// a second one finds the name taken and stays quiet.
+class SharedFramePublisher {
+private:
+    HANDLE mapping;
+    SharedFrameData* data;
+    
+public:
+    SharedFramePublisher();
+    ~SharedFramePublisher();
+    
+    // Prevent copying (owns the mapping)
+    SharedFramePublisher(const SharedFramePublisher&) = delete;
+    SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+    
+    bool isPublishing() const { return data != nullptr; }
+    void publish(const FrameBuffer& frame);
+};
+
+// Spectator side, a read-only view of the game's mapping
+class SharedFrameReader {
+private:
+    HANDLE mapping;
+    const SharedFrameData* data;
+    uint32_t lastSequence;
+    
+public:
+    SharedFrameReader();
+    ~SharedFrameReader();
+    
+    // Prevent copying (owns the view)
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+    
+    bool open();  // False if no game is publishing
+    bool isOpen() const { return data != nullptr; }
+    bool isGameRunning() const { return data && data->running.load(std::memory_order_acquire) != 0; }
+    
+    // Copies a newer frame than the last one read into cells (width x height).
+    // False if there's none, or the game was writing it the whole time.
+    bool readNewFrame(std::vector<char>& cells);
+};
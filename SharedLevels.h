@@ -0,0 +1,24 @@
+#pragma once
+#include "LevelTable.h"
+#include "RoomLayout.h"
+#include "DistanceField.h"
+#include <vector>
+
+// Level data the session server builds once and lends to all its headless
+// games: the parsed tables, the walls of each (RoomLayout) and one flow
+// field that the enemies of every room use in turn. The server steps its
+// games one after the other on one thread, which is what lets them share
+// the flow field; the rest is only read.
+struct SharedLevels {
+    std::vector<LevelTable> tables;
+    std::vector<RoomLayout> layouts;  // Per table, see buildLayouts
+    DistanceField flowField;
+    
+    // Once the tables are in, before the first game is created
+    void buildLayouts() {
+        layouts.clear();
+        for (const LevelTable& table : tables) {
+            layouts.emplace_back(table);
+        }
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include "Point.h"
+#include "AllocTracker.h"
+#include <vector>
+#include <cstdint>
+
+// Width x height grid that only stores the cells holding something other than
+// the fallback value: an open addressing table (linear probing) from cell
+// index to value. Setting a cell back to the fallback removes it (backward
+// shift, no tombstones), so the table grows with the cells set at one time,
+// not with the grid size or the cells ever written. Used by rooms whose walls
+// are shared (RoomLayout), where only a handful of elements are left per game.
+// Lookups write nothing, so const lookups may run on several threads at once.
+template <typename T>
+class SparseGrid {
+private:
+    struct Entry {
+        int cell;  // -1 = empty slot
+        T value;
+    };
+
+    int width;
+    int height;
+    T fallback;
+    std::vector<Entry> slots;  // Power of 2 size, at most half full
+    int used;
+    int shift;  // 32 - log2(slots.size())
+
+    int homeSlot(int cell) const {
+        return (int)(((uint32_t)cell * 2654435761u) >> shift);
+    }
+
+    // Slot holding cell, or the empty slot it would go into
+    int findSlot(int cell) const {
+        int mask = (int)slots.size() - 1;
+        int slot = homeSlot(cell);
+        while (slots[slot].cell != cell && slots[slot].cell >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void grow() {
+        AllocTracker::restartWarmup();  // More cells in use than ever before
+        std::vector<Entry> old;
+        old.swap(slots);
+        int size = old.empty() ? 16 : (int)old.size() * 2;
+        slots.assign(size, Entry{ -1, fallback });
+        shift = 32;
+        for (int s = size; s > 1; s >>= 1) shift--;
+        for (const Entry& entry : old) {
+            if (entry.cell >= 0) slots[findSlot(entry.cell)] = entry;
+        }
+    }
+
+    // Entries further along the probe run move up into the hole when that
+    // doesn't put them before their home slot
+    void erase(int slot) {
+        int mask = (int)slots.size() - 1;
+        int hole = slot;
+        for (int next = (hole + 1) & mask; slots[next].cell >= 0; next = (next + 1) & mask) {
+            int home = homeSlot(slots[next].cell);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = Entry{ -1, fallback };
+        used--;
+    }
+
+public:
+    SparseGrid(int w, int h, T fallbackValue) : width(w), height(h), fallback(fallbackValue), used(0), shift(32) {}
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    bool isInside(Point pos) const {
+        return pos.getX() >= 0 && pos.getX() < width && pos.getY() >= 0 && pos.getY() < height;
+    }
+
+    const T& get(Point pos) const {
+        if (used == 0 || !isInside(pos)) return fallback;
+        const Entry& entry = slots[findSlot(pos.getY() * width + pos.getX())];
+        return entry.cell >= 0 ? entry.value : fallback;
+    }
+
+    // Cells outside the grid are ignored
+    void set(Point pos, const T& value) {
+        if (!isInside(pos)) return;
+        int cell = pos.getY() * width + pos.getX();
+        bool clearing = value == fallback;
+
+        int slot = slots.empty() ? -1 : findSlot(cell);
+        if (slot >= 0 && slots[slot].cell == cell) {
+            if (clearing) {
+                erase(slot);
+            } else {
+                slots[slot].value = value;
+            }
+            return;
+        }
+        if (clearing) return;
+
+        if ((used + 1) * 2 > (int)slots.size()) {
+            grow();
+            slot = findSlot(cell);
+        }
+        slots[slot] = Entry{ cell, value };
+        used++;
+    }
+
+    // Keeps the table, a grid that is filled again doesn't allocate
+    void reset() {
+        for (Entry& entry : slots) {
+            entry = Entry{ -1, fallback };
+        }
+        used = 0;
+    }
+};
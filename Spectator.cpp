@@ -0,0 +1,63 @@
+#include "Spectator.h"
+#include "SharedFrame.h"
+#include "GameConfig.h"
+#include <conio.h>
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+// Redraws only the rows that differ from what is on the console
+static void drawChangedRows(const std::vector<char>& cells, std::vector<char>& shown) {
+    const int width = SCREEN_WIDTH;
+    const int height = SCREEN_HEIGHT + SCREEN_OFFSET_Y;
+    for (int row = 0; row < height; row++) {
+        const char* line = cells.data() + row * width;
+        if (std::memcmp(line, shown.data() + row * width, width) == 0) continue;
+        gotoxy(0, row);
+        std::cout.write(line, width);
+    }
+    std::cout.flush();
+    shown = cells;
+}
+
+static bool escapePressed() {
+    while (_kbhit()) {
+        if (_getch() == Keys::ESC) return true;
+    }
+    return false;
+}
+
+int runSpectator() {
+    SharedFrameReader reader;
+    std::vector<char> cells;
+    std::vector<char> shown;
+    
+    hideCursor();
+    clearScreen();
+    std::cout << "Waiting for a game to start... (ESC to leave)";
+    std::cout.flush();
+    
+    while (!escapePressed()) {
+        if (!reader.isOpen()) {
+            if (!reader.open()) {
+                Sleep(500);
+                continue;
+            }
+            clearScreen();
+            shown.assign(SCREEN_WIDTH * (SCREEN_HEIGHT + SCREEN_OFFSET_Y), ' ');
+        }
+        
+        if (reader.readNewFrame(cells)) {
+            drawChangedRows(cells, shown);
+        } else if (!reader.isGameRunning()) {
+            break;
+        }
+        Sleep(SPECTATOR_POLL_MILLIS);
+    }
+    
+    clearScreen();
+    if (reader.isOpen() && !reader.isGameRunning()) {
+        std::cout << "The game has ended." << std::endl;
+    }
+    return 0;
+}
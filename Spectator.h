@@ -0,0 +1,6 @@
+#pragma once
+
+// Watches the game running in another process on this machine (--watch),
+// through the frame it publishes in shared memory. Read only, any number of
+// spectators can watch at once. ESC leaves. Returns the process exit code.
+int runSpectator();
@@ -1,10 +1,14 @@
 #pragma once
 #include "GameElement.h"
 #include "Direction.h"
+#include "LevelFormat.h"
 #include "GameConfig.h"
-#include <vector>
 #include <iostream>
+#include <memory>
 
+// A spring is a straight run of '#' leaning on a wall.
+// position is the cell touching the wall, the spring extends from there in
+// its alignment direction, which is also the direction it launches players.
 class Spring : public GameElement {
 private:
     Direction alignment;  // Direction the spring faces (direction it will launch)
@@ -21,12 +25,10 @@ public:
     
     // Override draw to show all spring positions
     void draw() const override {
-        Point springDir = directionToPoint(alignment);
-        int displayLength = isCompressed ? (length - compressedLength) : length;
-        
-        for (int i = 0; i < displayLength; i++) {
-            Point drawPos = position + Point(springDir.getX() * i, springDir.getY() * i);
-            gotoxy(drawPos.getX(), drawPos.getY());
+        // Compressed chars disappear from the free end towards the wall
+        for (int i = 0; i < getDisplayLength(); i++) {
+            Point drawPos = getCellAt(i);
+            gotoxy(drawPos.getX(), drawPos.getY() + SCREEN_OFFSET_Y);
             std::cout << displayChar;
         }
     }
@@ -35,6 +37,7 @@ public:
     int getLength() const { return length; }
     int getCompressedLength() const { return compressedLength; }
     bool getIsCompressed() const { return isCompressed; }
+    int getDisplayLength() const { return isCompressed ? (length - compressedLength) : length; }
     
     void compress(int chars) {
         compressedLength = chars;
@@ -46,25 +49,43 @@ public:
         isCompressed = false;
     }
     
-    // Check if a position is part of this spring
-    bool isPartOfSpring(Point pos) const {
+    // Distance of pos from the wall end (0..length-1), or -1 if pos isn't part of this spring
+    int getOffsetOf(Point pos) const {
         Point springDir = directionToPoint(alignment);
-        for (int i = 0; i < length; i++) {
-            Point checkPos = position + Point(springDir.getX() * i, springDir.getY() * i);
-            if (checkPos == pos) {
-                return true;
-            }
-        }
-        return false;
+        int dx = pos.getX() - position.getX();
+        int dy = pos.getY() - position.getY();
+        int offset = dx * springDir.getX() + dy * springDir.getY();
+        
+        // Must lie on the spring's line and within its length
+        if (offset < 0 || offset >= length) return -1;
+        if (dx != springDir.getX() * offset || dy != springDir.getY() * offset) return -1;
+        return offset;
     }
     
-    // Get all positions that make up this spring
-    std::vector<Point> getAllPositions() const {
-        std::vector<Point> positions;
+    bool isPartOfSpring(Point pos) const { return getOffsetOf(pos) >= 0; }
+    
+    Point getCellAt(int offset) const {
         Point springDir = directionToPoint(alignment);
-        for (int i = 0; i < length; i++) {
-            positions.push_back(position + Point(springDir.getX() * i, springDir.getY() * i));
-        }
-        return positions;
+        return position + Point(springDir.getX() * offset, springDir.getY() * offset);
     }
 };
+
+// Builds the spring for the run of '#' whose left or top end is first (play coordinates).
+// isFreeSpring(p): p holds a '#' that no other spring took yet, isWall(p): p holds a wall.
+// markUsed(p) is called for every char of the run. The shape rules are in findSpringRun.
+template <typename IsFreeSpring, typename IsWall, typename MarkUsed>
+std::unique_ptr<Spring> makeSpringRun(Point first, IsFreeSpring isFreeSpring, IsWall isWall, MarkUsed markUsed) {
+    SpringShape shape = findSpringRun(first, isFreeSpring, isWall);
+    for (int i = 0; i < shape.length; i++) {
+        markUsed(Point(first.getX() + shape.step.getX() * i, first.getY() + shape.step.getY() * i));
+    }
+    return std::make_unique<Spring>(shape.anchor, shape.launchDir, shape.length);
+}
+
+// Entry of a room's spring map: the spring covering a cell and the cell's offset from the wall end
+struct SpringCell {
+    Spring* spring;  // nullptr when the cell has no spring
+    int offset;
+    
+    bool operator==(const SpringCell& other) const { return spring == other.spring && offset == other.offset; }
+};
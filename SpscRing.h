@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Single-producer single-consumer ring. The producer pushes and the consumer
+// pops, neither side ever waits for the other, a full ring makes tryPush
+// fail instead. Memory is fixed at construction.
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots;
+    uint32_t mask;
+    alignas(64) std::atomic<uint32_t> head;  // Next slot to fill, stored by the producer only
+    alignas(64) std::atomic<uint32_t> tail;  // Next slot to read, stored by the consumer only
+
+public:
+    explicit SpscRing(int capacity)  // Power of 2
+        : slots(capacity), mask((uint32_t)capacity - 1), head(0), tail(0) {}
+
+    bool tryPush(const T& value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t == (uint32_t)slots.size()) {
+            return false;  // Full
+        }
+        slots[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);  // Publishes the slot
+        return true;
+    }
+
+    int popBatch(T* out, int maxCount) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        int count = (int)std::min(h - t, (uint32_t)maxCount);
+        for (int i = 0; i < count; i++) {
+            out[i] = slots[(t + i) & mask];
+        }
+        tail.store(t + count, std::memory_order_release);  // Hands the slots back
+        return count;
+    }
+};
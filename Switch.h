@@ -1,13 +1,15 @@
 #pragma once
 #include "GameElement.h"
+#include "TriggerGraph.h"
 
 class Switch : public GameElement {
 private:
     bool isOn;
     int groupId;  // Which door group this switch belongs to
+    TriggerGraph* triggers;  // Non-owning, set when added to a room
     
 public:
-    Switch(Point pos, int group) : GameElement(pos, '\\'), isOn(false), groupId(group) {}
+    Switch(Point pos, int group) : GameElement(pos, '\\'), isOn(false), groupId(group), triggers(nullptr) {}
     
     bool canPlayerPass() const override { return true; }
     
@@ -15,7 +17,17 @@ public:
     void toggle() { 
         isOn = !isOn; 
         displayChar = isOn ? '/' : '\\';  // Visual feedback
+        if (triggers) {
+            triggers->onSwitchToggled(groupId, isOn);  // Keep the group count up to date
+        }
     }
     
     int getGroupId() const { return groupId; }
+    
+    // Restoring a saved state: the group counts are restored separately, nothing fires
+    void setOn(bool on) {
+        isOn = on;
+        displayChar = isOn ? '/' : '\\';
+    }
+    void setTriggerGraph(TriggerGraph* graph) { triggers = graph; }
 };
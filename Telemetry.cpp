@@ -0,0 +1,54 @@
+#include "Telemetry.h"
+#include "AllocTracker.h"
+#include "GameConfig.h"
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+Telemetry::Telemetry(const std::string& file)
+    : filename(file), ring(TELEMETRY_RING_SIZE), dropped(0), running(true) {
+    writer = std::thread(&Telemetry::writerLoop, this);
+}
+
+Telemetry::~Telemetry() {
+    running.store(false);
+    writer.join();
+}
+
+void Telemetry::record(const TelemetryEvent& event) {
+    if (!ring.tryPush(event)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Telemetry::writerLoop() {
+    AllocTracker::setSubsystem(AllocSubsystem::TELEMETRY);
+    std::ofstream out;
+    std::vector<TelemetryEvent> batch(TELEMETRY_RING_SIZE);
+    uint32_t droppedWritten = 0;
+    
+    while (true) {
+        // Read the flag first, so nothing recorded before the game stopped is left behind
+        bool stopping = !running.load();
+        int count = ring.popBatch(batch.data(), (int)batch.size());
+        uint32_t droppedNow = dropped.load(std::memory_order_relaxed);
+        
+        if (count > 0 || droppedNow != droppedWritten) {
+            if (!out.is_open()) {
+                out.open(filename, std::ios::binary | std::ios::trunc);
+                uint32_t version = TELEMETRY_FORMAT_VERSION;
+                out.write("TAGT", 4);
+                out.write((const char*)&version, sizeof(version));
+            }
+            uint32_t header[2] = { (uint32_t)count, droppedNow - droppedWritten };
+            out.write((const char*)header, sizeof(header));
+            out.write((const char*)batch.data(), (std::streamsize)count * sizeof(TelemetryEvent));
+            out.flush();
+            droppedWritten = droppedNow;
+            continue;  // There may be more
+        }
+        
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_MILLIS));
+    }
+}
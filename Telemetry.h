@@ -0,0 +1,36 @@
+#pragma once
+#include "TelemetryFormat.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+
+// Events go from the game thread to the writer thread through this
+typedef SpscRing<TelemetryEvent> TelemetryRing;
+
+// Gameplay analytics. record() only copies the event into the ring, a
+// background thread writes batches to the file (opened with the first batch)
+// and events that don't fit in the ring are counted as dropped.
+class Telemetry {
+private:
+    std::string filename;
+    TelemetryRing ring;
+    std::atomic<uint32_t> dropped;
+    std::atomic<bool> running;
+    std::thread writer;
+
+    void writerLoop();
+
+public:
+    explicit Telemetry(const std::string& file);
+    ~Telemetry();  // Writes what's left in the ring
+
+    // Prevent copying (owns the writer thread)
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Game thread only, never blocks
+    void record(const TelemetryEvent& event);
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
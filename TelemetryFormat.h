@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// Telemetry file, shared by the game (Telemetry) and the TelemetryReader tool:
+//   "TAGT", format version (uint32)
+//   blocks: event count (uint32), events dropped after these (uint32),
+//           then count fixed-size TelemetryEvent records
+// Events are only dropped while the ring is full, so the dropped ones came
+// after the events of the block that was waiting in it.
+// Everything little-endian, records are written as they are in memory.
+const int TELEMETRY_FORMAT_VERSION = 1;
+
+enum class TelemetryType : uint8_t {
+    GAME_START,      // value = player count
+    PICKUP,          // detail = item char
+    DOOR,            // value = room entered, -1 = finished the game
+    RIDDLE_SOLVED,
+    RIDDLE_FAILED,
+    BOMB_DETONATED,  // No player, chain reactions are reported bomb by bomb
+    LIFE_LOST,       // detail = cause ('E' enemy, '?' riddle), value = lives left
+    TYPE_COUNT
+};
+
+const uint8_t TELEMETRY_NO_PLAYER = 0xFF;
+
+struct TelemetryEvent {
+    uint32_t tick;    // Game cycle since the game started
+    uint8_t type;     // TelemetryType
+    uint8_t player;   // Player index or TELEMETRY_NO_PLAYER
+    uint8_t room;     // Room index
+    char detail;
+    int16_t x;        // Play-area position
+    int16_t y;
+    int32_t value;
+};
+static_assert(sizeof(TelemetryEvent) == 16, "telemetry records must stay 16 bytes");
+
+inline const char* getTelemetryTypeName(uint8_t type) {
+    static const char* const names[] = {
+        "game-start", "pickup", "door", "riddle-solved", "riddle-failed", "bomb", "life-lost"
+    };
+    return type < (uint8_t)TelemetryType::TYPE_COUNT ? names[type] : "unknown";
+}
+
+inline bool readTelemetryHeader(std::istream& in) {
+    char magic[4];
+    uint32_t version = 0;
+    in.read(magic, 4);
+    in.read((char*)&version, sizeof(version));
+    return in && magic[0] == 'T' && magic[1] == 'A' && magic[2] == 'G' && magic[3] == 'T' &&
+           version == (uint32_t)TELEMETRY_FORMAT_VERSION;
+}
+
+// Returns false at the end of the file or on a cut-off block
+inline bool readTelemetryBlock(std::istream& in, std::vector<TelemetryEvent>& events, uint32_t& dropped) {
+    uint32_t count = 0;
+    in.read((char*)&count, sizeof(count));
+    in.read((char*)&dropped, sizeof(dropped));
+    if (!in) return false;
+    
+    events.resize(count);
+    in.read((char*)events.data(), (std::streamsize)count * sizeof(TelemetryEvent));
+    return (bool)in;
+}
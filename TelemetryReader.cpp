@@ -0,0 +1,58 @@
+// Prints a telemetry file written by the game, one event per line,
+// followed by a count per event type.
+//   TelemetryReader [file]     (default: telemetry.bin)
+#include "TelemetryFormat.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    const char* filename = argc > 1 ? argv[1] : "telemetry.bin";
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open " << filename << std::endl;
+        return 1;
+    }
+    if (!readTelemetryHeader(in)) {
+        std::cerr << "Error: " << filename << " is not a telemetry file of version "
+                  << TELEMETRY_FORMAT_VERSION << std::endl;
+        return 1;
+    }
+    
+    std::vector<TelemetryEvent> events;
+    uint32_t dropped = 0;
+    uint32_t totalDropped = 0;
+    long long counts[(int)TelemetryType::TYPE_COUNT + 1] = {};
+    
+    while (readTelemetryBlock(in, events, dropped)) {
+        for (const TelemetryEvent& event : events) {
+            std::cout << "tick " << event.tick << "  " << getTelemetryTypeName(event.type)
+                      << "  room " << (int)event.room;
+            if (event.player != TELEMETRY_NO_PLAYER) {
+                std::cout << "  player " << (int)event.player;
+            }
+            std::cout << "  at " << event.x << "," << event.y;
+            if (event.detail != ' ') {
+                std::cout << "  '" << event.detail << "'";
+            }
+            std::cout << "  value " << event.value << std::endl;
+            
+            int type = event.type < (uint8_t)TelemetryType::TYPE_COUNT ? event.type : (int)TelemetryType::TYPE_COUNT;
+            counts[type]++;
+        }
+        
+        if (dropped > 0) {
+            std::cout << "(" << dropped << " events dropped)" << std::endl;
+            totalDropped += dropped;
+        }
+    }
+    
+    std::cout << std::endl;
+    for (int type = 0; type <= (int)TelemetryType::TYPE_COUNT; type++) {
+        if (counts[type] > 0) {
+            std::cout << getTelemetryTypeName((uint8_t)type) << ": " << counts[type] << std::endl;
+        }
+    }
+    std::cout << "dropped: " << totalDropped << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "TriggerGraph.h"
+#include "Room.h"
+#include "LevelFormat.h"
+
+TriggerWiring::TriggerWiring() {
+    for (int i = 0; i < 10; i++) {
+        doorGroups[i] = -1;
+    }
+}
+
+bool TriggerWiring::parseLine(const std::string& line) {
+    WiringLine parsed = parseWiringLine(line.c_str(), (int)line.length());
+    TriggerAction action;
+    action.target = Point(parsed.a, parsed.b);
+
+    switch (parsed.kind) {
+        case WiringLine::Kind::SWITCH:
+            switches.push_back({ Point(parsed.a, parsed.b), parsed.group });
+            return true;
+
+        case WiringLine::Kind::DOOR:
+            doorGroups[parsed.a] = parsed.group;
+            return true;
+
+        case WiringLine::Kind::OPEN_WALL:
+            action.type = TriggerAction::Type::OPEN_WALL;
+            actions.push_back({ parsed.group, action });
+            return true;
+
+        case WiringLine::Kind::ARM_BOMB:
+            action.type = TriggerAction::Type::ARM_BOMB;
+            actions.push_back({ parsed.group, action });
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+int TriggerWiring::getSwitchGroup(Point pos) const {
+    for (const SwitchEntry& entry : switches) {
+        if (entry.pos == pos) {
+            return entry.group;
+        }
+    }
+    return 0;  // Unlisted switches belong to group 0
+}
+
+int TriggerWiring::getDoorGroup(int digit) const {
+    if (digit < 1 || digit > 9) return -1;
+    return doorGroups[digit];
+}
+
+TriggerGraph::TriggerGraph(Room* owner) : room(owner) {}
+
+TriggerGraph::Group& TriggerGraph::getGroup(int group) {
+    if (group >= (int)groups.size()) {
+        groups.resize(group + 1, Group{ 0, 0, {} });
+    }
+    return groups[group];
+}
+
+void TriggerGraph::addSwitch(int group, bool isOn) {
+    if (group < 0) return;
+    Group& g = getGroup(group);
+    g.switchCount++;
+    if (isOn) {
+        g.satisfiedCount++;
+    }
+}
+
+void TriggerGraph::removeSwitch(int group, bool wasOn) {
+    // A destroyed switch no longer holds its door shut
+    if (!wasOn) {
+        changeSatisfied(group, +1);
+    }
+}
+
+void TriggerGraph::onSwitchToggled(int group, bool isOn) {
+    changeSatisfied(group, isOn ? +1 : -1);
+}
+
+void TriggerGraph::addAction(int group, TriggerAction action) {
+    if (group < 0) return;
+    getGroup(group).actions.push_back(action);
+}
+
+void TriggerGraph::changeSatisfied(int group, int delta) {
+    if (group < 0 || group >= (int)groups.size()) return;
+
+    bool wasActive = isGroupActive(group);
+    groups[group].satisfiedCount += delta;
+
+    // Fan out when the group turns ON
+    if (!wasActive && isGroupActive(group)) {
+        for (const TriggerAction& action : groups[group].actions) {
+            room->runTriggerAction(action);
+        }
+    }
+}
+
+bool TriggerGraph::isGroupActive(int group) const {
+    if (group < 0) return true;  // No switches required
+    if (group >= (int)groups.size()) return false;
+    const Group& g = groups[group];
+    return g.switchCount > 0 && g.satisfiedCount == g.switchCount;
+}
+
+void TriggerGraph::writeCounts(StateWriter& out) const {
+    out.writeInt((int)groups.size());
+    for (const Group& g : groups) {
+        out.writeInt(g.switchCount);
+        out.writeInt(g.satisfiedCount);
+    }
+}
+
+void TriggerGraph::readCounts(StateReader& in) {
+    int count = in.readInt();
+    if (count < 0 || count > (int)groups.size()) {
+        in.fail();  // Groups only come from the wiring, which doesn't change
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        groups[i].switchCount = in.readInt();
+        groups[i].satisfiedCount = in.readInt();
+    }
+}
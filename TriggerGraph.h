@@ -0,0 +1,83 @@
+#pragma once
+#include "Point.h"
+#include "SaveFile.h"
+#include <vector>
+#include <string>
+
+class Room;
+
+// Something that happens when all switches of a group are ON
+struct TriggerAction {
+    enum class Type {
+        OPEN_WALL,  // Remove the wall at target
+        ARM_BOMB    // Activate the bomb at target
+    };
+
+    Type type;
+    Point target;
+};
+
+// Switch-group wiring declared in the lines below a screen's play area:
+//   switch <x> <y> <group>      switch at x,y belongs to group (default 0)
+//   door <digit> <group>        doors showing digit need group to be ON
+//   on <group> open <x> <y>     group ON removes the wall at x,y
+//   on <group> arm <x> <y>      group ON activates the bomb at x,y
+// Coordinates are play-area coordinates (file line - SCREEN_OFFSET_Y).
+struct TriggerWiring {
+    struct SwitchEntry {
+        Point pos;
+        int group;
+    };
+    struct ActionEntry {
+        int group;
+        TriggerAction action;
+    };
+
+    std::vector<SwitchEntry> switches;
+    int doorGroups[10];  // door digit -> group, -1 = not wired
+    std::vector<ActionEntry> actions;
+
+    TriggerWiring();
+
+    // Returns false if the line isn't a wiring line
+    bool parseLine(const std::string& line);
+
+    int getSwitchGroup(Point pos) const;
+    int getDoorGroup(int digit) const;
+};
+
+// Per room trigger graph. Each group keeps a running count of satisfied
+// switches, updated by Switch::toggle, so checking a group is O(1).
+// When a group turns ON its actions fire.
+class TriggerGraph {
+private:
+    struct Group {
+        int switchCount;     // Switches ever wired to this group
+        int satisfiedCount;  // Switches that are ON (destroyed ones count too)
+        std::vector<TriggerAction> actions;
+    };
+
+    Room* room;  // Owner, runs the actions
+    std::vector<Group> groups;
+
+    Group& getGroup(int group);
+    void changeSatisfied(int group, int delta);
+
+public:
+    TriggerGraph(Room* owner);
+
+    // Prevent copying (holds a pointer to its room)
+    TriggerGraph(const TriggerGraph&) = delete;
+    TriggerGraph& operator=(const TriggerGraph&) = delete;
+
+    void addSwitch(int group, bool isOn);
+    void removeSwitch(int group, bool wasOn);  // Switch destroyed
+    void onSwitchToggled(int group, bool isOn);
+    void addAction(int group, TriggerAction action);
+
+    bool isGroupActive(int group) const;
+    
+    // Switch counts of every group (the actions come from the wiring, they're not state)
+    void writeCounts(StateWriter& out) const;
+    void readCounts(StateReader& in);
+};
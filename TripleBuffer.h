@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+
+// Hands the newest value from one writer thread to one reader thread without
+// either ever waiting. Three slots: the writer fills its back slot and swaps
+// it with the middle one, the reader swaps its front slot with the middle one
+// when that holds something it hasn't seen. Values the reader was too slow to
+// take are overwritten, which is the point: it only ever sees the newest.
+template <typename T>
+class TripleBuffer {
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;  // Middle slot holds a value the reader hasn't taken
+
+    T slots[3];
+    int back;   // Writer only
+    int front;  // Reader only
+    alignas(64) std::atomic<int> middle;
+
+public:
+    TripleBuffer() : slots(), back(0), front(1), middle(2) {}
+
+    // Prevent copying (shared between two threads)
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: fill this, then publish it
+    T& getBack() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: the newest published value if there's one it hasn't taken yet,
+    // nullptr otherwise. Stays valid until the next call.
+    const T* takeNewest() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return nullptr;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return &slots[front];
+    }
+};
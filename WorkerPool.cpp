@@ -0,0 +1,76 @@
+#include "WorkerPool.h"
+#include "AllocTracker.h"
+
+WorkerPool::WorkerPool(int threadCount)
+    : task(nullptr), taskCount(0), nextTask(0), unfinished(0), generation(0), stopping(false) {
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::runAll(int count, const std::function<void(int)>& work) {
+    if (count <= 0) return;
+
+    // Nothing to share, skip the handoff
+    if (count == 1 || threads.empty()) {
+        for (int i = 0; i < count; i++) {
+            work(i);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &work;
+    taskCount = count;
+    nextTask = 0;
+    unfinished = count;
+    generation++;
+    wakeUp.notify_all();
+
+    // Help out, then wait for the stragglers (the barrier)
+    while (runNextTask(lock)) {}
+    batchDone.wait(lock, [this] { return unfinished == 0; });
+    task = nullptr;
+}
+
+// Takes one task of the current batch and runs it unlocked. False when none are left.
+bool WorkerPool::runNextTask(std::unique_lock<std::mutex>& lock) {
+    if (!task || nextTask >= taskCount) return false;
+
+    int index = nextTask++;
+    const std::function<void(int)>& work = *task;
+
+    lock.unlock();
+    work(index);
+    lock.lock();
+
+    if (--unfinished == 0) {
+        batchDone.notify_all();
+    }
+    return true;
+}
+
+void WorkerPool::workerLoop() {
+    AllocTracker::setSubsystem(AllocSubsystem::WORKERS);
+    std::unique_lock<std::mutex> lock(mutex);
+    int seenGeneration = generation;
+
+    while (true) {
+        wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+        if (stopping) return;
+
+        seenGeneration = generation;
+        while (runNextTask(lock)) {}
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads that run a batch of independent tasks.
+// runAll hands out task indices 0..count-1 to the workers (the calling thread
+// helps too) and returns only when every task is done, so it doubles as the
+// barrier between the parallel part of a tick and whatever comes after it.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeUp;    // New batch or shutdown
+    std::condition_variable batchDone;
+
+    const std::function<void(int)>* task;  // Current batch, valid during runAll
+    int taskCount;
+    int nextTask;
+    int unfinished;
+    int generation;  // Bumped for every batch so sleeping workers notice it
+    bool stopping;
+
+    void workerLoop();
+    bool runNextTask(std::unique_lock<std::mutex>& lock);
+
+public:
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    // Prevent copying
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int getThreadCount() const { return (int)threads.size(); }
+
+    // Calls work(i) for every i in [0, count) and waits for all of them
+    void runAll(int count, const std::function<void(int)>& work);
+};
@@ -1,7 +1,55 @@
 #include "Game.h"
+#include "SessionServer.h"
+#include "SessionClient.h"
+#include "Spectator.h"
+#include "Replay.h"
+#include "LevelGenerator.h"
+#include <string>
+#include <cstdlib>
 
-int main() {
-    Game game;
+int main(int argc, char* argv[]) {
+    // --players N comes before everything else, the other options follow as usual
+    int playerCount = DEFAULT_PLAYER_COUNT;
+    if (argc > 2 && std::string(argv[1]) == "--players") {
+        playerCount = std::atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+    
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::string socketPath = argc > 2 ? argv[2] : SESSION_SOCKET;
+    
+    // Many games in one process, played from --connect clients
+    if (mode == "--serve") {
+        SessionServer server;
+        int generatedRooms = argc > 3 ? std::atoi(argv[3]) : 0;  // Instead of the screen files
+        uint32_t seed = argc > 4 ? (uint32_t)std::strtoul(argv[4], nullptr, 10) : 1;
+        if (!server.start(socketPath, generatedRooms, seed, playerCount)) return 1;
+        server.run();
+        return 0;
+    }
+    if (mode == "--connect") {
+        return runSessionClient(socketPath);
+    }
+    // Watches the game running on this machine, read only
+    if (mode == "--watch") {
+        return runSpectator();
+    }
+    // Random solvable rooms, written as screen files
+    if (mode == "--generate") {
+        int count = argc > 2 ? std::atoi(argv[2]) : GENERATOR_ROOM_COUNT;
+        uint32_t seed = argc > 3 ? (uint32_t)std::strtoul(argv[3], nullptr, 10) : 1;
+        return runGenerator(count, seed, argc > 4 ? argv[4] : GENERATOR_DIRECTORY, playerCount);
+    }
+    if (mode == "--replay") {
+        std::string filename = argc > 2 ? argv[2] : std::string(RECORDING_NAME) + ".rec";
+        return runReplay(filename, argc > 3 ? std::atoi(argv[3]) : 0);
+    }
+    
+    Game game(playerCount);
+    if (mode == "--record") {
+        game.startRecording(argc > 2 ? argv[2] : RECORDING_NAME);
+    }
     game.run();
     return 0;
 }